@@ -3,11 +3,13 @@
 #include "SBFcoDecoder.h"
 #include "SBFDecoder.h"
 #include "bnccore.h"
+#include "b2b_trace.h"
 #include <iostream>
 #include <cstring>
 #include <cstdio>
 #include <cmath>
 #include <cstdlib>
+#include <type_traits>
 
 // Helper macros and functions from utils.c (or adapted)
 static int md_julday(int iyear, int imonth, int iday) {
@@ -74,16 +76,33 @@ static int syssig_prn(int prn) {
     return a;
 }
 
-bool g_b2bDebugSatPrint = false;
+// History keys: (SSR, BDS week, second of week) of an orbit/clock epoch and
+// (SSR, IODP) of a mask
+static quint64 b2bEpochKey(int ssr, int week, int sow) {
+    return (quint64(ssr & 3) << 36) | (quint64(week & 0xFFFF) << 20) | quint64(sow & 0xFFFFF);
+}
+
+static quint64 b2bMaskKey(int ssr, int iodp) {
+    return quint64(((ssr & 3) << 4) | (iodp & 15));
+}
+
+// Trace sink: formatted B2B_TRACE messages, delivered on the drain thread
+static void b2bTraceToCore(int, const char* text) {
+    BNC_CORE->slotMessage(QByteArray(text), false);
+}
+
+// Live decoders; the first installs the trace sink, the last flushes and
+// removes it so the drain thread never calls into a torn-down core
+static QMutex b2bTraceSinkMutex;
+static int    b2bTraceSinkUsers = 0;
 
 PPPB2bDecoder::PPPB2bDecoder() {
     // Initialize state variables
-    ssr_clock_count = 0;
-    ssr_orbit_count = 0;
-    ssr_mask_count = 0;
-    memset(ssr_orbits, 0, sizeof(ssr_orbits));
-    memset(ssr_clocks, 0, sizeof(ssr_clocks));
-    memset(ssr_masks, 0, sizeof(ssr_masks));
+    ssr_orbits.reset(IF_MAXSSR);
+    ssr_clocks.reset(IF_MAXSSR);
+    ssr_masks.reset(IF_MAXMASK);
+    _orbDirty.reserve(IF_MAXSAT);
+    _clkDirty.reserve(IF_MAXSAT);
     memset(&ssr_config, 0, sizeof(ssr_config));
 
     gnssinit(nullptr, nullptr);
@@ -96,9 +115,29 @@ PPPB2bDecoder::PPPB2bDecoder() {
     _epochC59Avail = false;
     _epochC60Avail = false;
     _epochC61Avail = false;
+    _pageCacheHits = 0;
+    _pageCacheMisses = 0;
+    _rxCrcBypass = false;
+    _rxCrcVerify = true;
+    _shadowFraction = 0.0;
+    _shadowChecked = 0;
+    _shadowDiverged = 0;
+    _shadowPending = 0;
+
+    QMutexLocker locker(&b2bTraceSinkMutex);
+    if (b2bTraceSinkUsers++ == 0) b2b_trace_set_sink(b2bTraceToCore);
 }
 
 PPPB2bDecoder::~PPPB2bDecoder() {
+    {
+        QMutexLocker locker(&_ldpcStatsMutex);
+        while (_shadowPending > 0) _shadowIdle.wait(&_ldpcStatsMutex);
+    }
+    {
+        QMutexLocker locker(&b2bTraceSinkMutex);
+        b2b_trace_flush();
+        if (--b2bTraceSinkUsers == 0) b2b_trace_set_sink(nullptr);
+    }
     if (ssr_config.fp_output) {
         fclose(ssr_config.fp_output);
         ssr_config.fp_output = nullptr;
@@ -113,8 +152,353 @@ void PPPB2bDecoder::setStaID(const QString& staID) {
     _staID = staID;
 }
 
+void PPPB2bDecoder::setCorrectionHistoryDepth(int epochs) {
+    ssr_orbits.reset(epochs);
+    ssr_clocks.reset(epochs);
+}
+
 void PPPB2bDecoder::setVerboseSatPrint(bool enabled) {
-    g_b2bDebugSatPrint = enabled;
+    b2b_trace_set_level(enabled ? B2B_TRACE_VERBOSE : B2B_TRACE_INFO);
+}
+
+QMap<QPair<int, int>, b2b_ldpc_stats> PPPB2bDecoder::ldpcStats() const {
+    QMutexLocker locker(&_ldpcStatsMutex);
+    return _ldpcStats;
+}
+
+void PPPB2bDecoder::resetLdpcStats() {
+    QMutexLocker locker(&_ldpcStatsMutex);
+    _ldpcStats.clear();
+}
+
+void PPPB2bDecoder::setLdpcConfig(const SBFcoDecoder::Config& config) {
+    _ldpcBudget.setBase(config);
+}
+
+SBFcoDecoder::Config PPPB2bDecoder::ldpcConfig() const {
+    return _ldpcBudget.base();
+}
+
+void PPPB2bDecoder::setLdpcBudgetNs(qint64 budgetNs) {
+    _ldpcBudget.setBudgetNs(budgetNs);
+}
+
+static quint64 b2b_page_hash(int prn, uint16_t week, uint32_t tow, const quint32* nav) {
+    // FNV-1a over (PRN, WNc, TOW, NAVBits)
+    quint64 h = 14695981039346656037ULL;
+    auto mix = [&h](quint32 v) {
+        for (int i = 0; i < 4; i++) {
+            h ^= (v >> (8 * i)) & 0xFF;
+            h *= 1099511628211ULL;
+        }
+    };
+    mix(quint32(prn));
+    mix(quint32(week));
+    mix(tow);
+    for (int w = 0; w < B2B_NAV_WORDS; w++) mix(nav[w]);
+    return h;
+}
+
+PPPB2bDecoder::B2bPageCacheEntry* PPPB2bDecoder::lookupPageCache(int prn, uint16_t week, uint32_t tow, const quint32* nav) {
+    quint64 h = b2b_page_hash(prn, week, tow, nav);
+    B2bPageCacheEntry& e = _pageCache[h % B2B_PAGE_CACHE_SIZE];
+    if (e.valid && e.hash == h && e.prn == prn && e.week == week && e.tow == tow &&
+        memcmp(e.nav, nav, sizeof(e.nav)) == 0) {
+        _pageCacheHits++;
+        return &e;
+    }
+    _pageCacheMisses++;
+    return nullptr;
+}
+
+void PPPB2bDecoder::storePageCache(int prn, uint16_t week, uint32_t tow, const quint32* nav,
+                                   const QByteArray& decoded, const SBFcoDecoder::DecodeInfo& info) {
+    quint64 h = b2b_page_hash(prn, week, tow, nav);
+    B2bPageCacheEntry& e = _pageCache[h % B2B_PAGE_CACHE_SIZE];
+    e.valid = true;
+    e.hash = h;
+    e.prn = prn;
+    e.week = week;
+    e.tow = tow;
+    memcpy(e.nav, nav, sizeof(e.nav));
+    e.decoded = decoded;
+    e.info = info;
+}
+
+PPPB2bDecoder::B2bReceptionSet& PPPB2bDecoder::addReception(int prn, uint16_t week, uint32_t tow, const quint32* nav,
+                                                            double errProb) {
+    // One set per GEO PRN; a new page epoch of that PRN replaces the old set
+    B2bReceptionSet& rs = _receptions[prn % B2B_VOTE_SLOTS];
+    if (!rs.valid || rs.prn != prn || rs.week != week || rs.tow != tow) {
+        rs.valid = true;
+        rs.resolved = false;
+        rs.prn = prn;
+        rs.week = week;
+        rs.tow = tow;
+        rs.ncopies = 0;
+    }
+    // A repeat of bits already in the set (re-send, reconnect, a cache hit)
+    // counts once, so it cannot outvote a differing copy
+    for (int c = 0; c < rs.ncopies; ++c) {
+        if (memcmp(rs.nav[c], nav, sizeof(rs.nav[0])) == 0) return rs;
+    }
+    if (rs.ncopies < B2B_VOTE_COPIES) {
+        memcpy(rs.nav[rs.ncopies], nav, sizeof(rs.nav[0]));
+        rs.errProb[rs.ncopies] = errProb;
+        rs.ncopies++;
+    }
+    return rs;
+}
+
+void PPPB2bDecoder::decodeMeasEpoch(const uint8_t* payload, int payload_len) {
+    // MeasEpoch: 12-byte header, N1 Type-1 sub-blocks, each followed by its
+    // N2 Type-2 sub-blocks. Only the B2b C/N0 of the PPP GEOs is kept.
+    if (payload_len < 12) return;
+    uint32_t tow = U4(payload + 0) / 1000;
+    uint16_t week = U2(payload + 4);
+    int n1 = payload[6];
+    int sb1Len = payload[7];
+    int sb2Len = payload[8];
+    if (sb1Len < 20 || sb2Len < 6) return;
+    // Signal number: Type bits 0-4, or 32 + ObsInfo bits 3-7 when those read 31
+    auto signal = [](uint8_t type, uint8_t obsInfo) {
+        int sig = type & 0x1F;
+        return sig == 31 ? 32 + (obsInfo >> 3) : sig;
+    };
+    auto store = [&](int rxch, int prn, int sig, uint8_t rawCn0) {
+        if (sig != SBF_SIGNAL_BDS_B2B || rawCn0 == 255) return;
+        B2bChannelQuality& q = _channelQuality[QPair<int, int>(prn, rxch)];
+        q.cn0 = rawCn0 * 0.25 + 10.0;
+        q.cn0Week = week;
+        q.cn0Tow = tow;
+    };
+    int pos = 12;
+    for (int i = 0; i < n1 && pos + sb1Len <= payload_len; ++i) {
+        const uint8_t* sb1 = payload + pos;
+        int rxch = sb1[0];
+        int svid = sb1[2];
+        int n2 = sb1[19];
+        pos += sb1Len;
+        // BeiDou SVIDs 223-245 are C41-C63
+        int prn = (svid >= 223 && svid <= 245) ? svid - 182 : 0;
+        bool geo = prn >= 59 && prn <= 61;
+        if (geo) store(rxch, prn, signal(sb1[1], sb1[18]), sb1[15]);
+        for (int j = 0; j < n2 && pos + sb2Len <= payload_len; ++j) {
+            const uint8_t* sb2 = payload + pos;
+            if (geo) store(rxch, prn, signal(sb2[0], sb2[5]), sb2[2]);
+            pos += sb2Len;
+        }
+    }
+}
+
+void PPPB2bDecoder::updateChannelErrRate(int prn, int rxch, int nerr) {
+    if (nerr < 0) return;
+    B2bChannelQuality& q = _channelQuality[QPair<int, int>(prn, rxch)];
+    double rate = double(nerr) / B2B_LDPC_BITS;
+    q.errRate = q.pages == 0 ? rate : q.errRate + (rate - q.errRate) / 8.0;
+    q.pages++;
+}
+
+double PPPB2bDecoder::channelErrProb(int prn, int rxch, uint16_t week, uint32_t tow) const {
+    QMap<QPair<int, int>, B2bChannelQuality>::const_iterator it = _channelQuality.constFind(QPair<int, int>(prn, rxch));
+    if (it == _channelQuality.constEnd()) return 0.0;
+    const B2bChannelQuality& q = it.value();
+    if (q.cn0 > 0.0 && q.cn0Week == week && qAbs(qint64(tow) - qint64(q.cn0Tow)) <= B2B_CN0_MAX_AGE) {
+        return SBFcoDecoder::errProbFromCN0(q.cn0);
+    }
+    // Clean pages with no corrections still bound the rate by about one bit in
+    // the window, which keeps a quiet channel from claiming certainty
+    if (q.pages >= B2B_ERR_EST_MIN_PAGES) return qMax(q.errRate, 1e-4);
+    return 0.0;
+}
+
+void PPPB2bDecoder::pageCacheStats(quint64& hits, quint64& misses) const {
+    hits = _pageCacheHits;
+    misses = _pageCacheMisses;
+}
+
+void PPPB2bDecoder::setReceiverCrcBypass(bool enabled, bool verifyCrc) {
+    _rxCrcBypass = enabled;
+    _rxCrcVerify = verifyCrc;
+}
+
+void PPPB2bDecoder::setShadowVerifyFraction(double fraction) {
+    _shadowFraction = qBound(0.0, fraction, 1.0);
+}
+
+void PPPB2bDecoder::shadowVerifyStats(quint64& checked, quint64& diverged) const {
+    QMutexLocker locker(&_ldpcStatsMutex);
+    checked = _shadowChecked;
+    diverged = _shadowDiverged;
+}
+
+// Takes one of the B2B_SHADOW_MAX_PENDING task slots; a sample that finds
+// them all taken is skipped rather than queued
+bool PPPB2bDecoder::reserveShadowSlot() {
+    QMutexLocker locker(&_ldpcStatsMutex);
+    if (_shadowPending >= B2B_SHADOW_MAX_PENDING) return false;
+    _shadowPending++;
+    return true;
+}
+
+// Counts a finished shadow decode and releases its slot
+void PPPB2bDecoder::recordShadowResult(bool diverged) {
+    QMutexLocker locker(&_ldpcStatsMutex);
+    _shadowChecked++;
+    if (diverged) _shadowDiverged++;
+    if (--_shadowPending == 0) _shadowIdle.wakeAll();
+}
+
+// One background thread runs the shadow decodes of all decoders
+namespace {
+struct B2bShadowPool : public QThreadPool {
+    B2bShadowPool() { setMaxThreadCount(1); }
+};
+}
+
+static QThreadPool* b2bShadowPool() {
+    static B2bShadowPool pool;
+    return &pool;
+}
+
+// Re-decodes one page with SBFcoDecoder::decode_page_reference(), a separate
+// copy of the original decoder run with the production iteration and EMS
+// limits, and compares the 486-bit message and its parse with what the
+// production path handed to the parser. A page the reference decodes
+// CRC-clean must come out of production identically; a production-only
+// success (voting, min-max, tuned messages) is not a divergence.
+class B2bShadowTask : public QRunnable {
+ public:
+    B2bShadowTask(PPPB2bDecoder* owner, int prn, uint16_t week, uint32_t tow, const quint32* nav,
+                  const QByteArray& decoded, bool crcOk, const SBFcoDecoder::Config& limits)
+        : _owner(owner), _prn(prn), _week(week), _tow(tow), _decoded(decoded), _crcOk(crcOk), _limits(limits) {
+        memcpy(_nav, nav, sizeof(_nav));
+    }
+
+    void run() override {
+        // The codeword follows 12 leading bits, as in b2b_ldpc_decode()
+        const int SKIP_BITS = 12;
+        SBFcoDecoder::Page page;
+        for (int i = 0; i < 162; ++i) {
+            uint8_t v = 0;
+            for (int b = 0; b < 6; ++b) {
+                int pos = SKIP_BITS + i * 6 + b;
+                v = uint8_t((v << 1) | ((_nav[pos / 32] >> (31 - pos % 32)) & 1u));
+            }
+            page.syms[i] = v;
+        }
+        SBFcoDecoder::Result res;
+        SBFcoDecoder::decode_page_reference(page, res, _limits);
+        unsigned char ref[B2B_MSG_BYTES];
+        memset(ref, 0, sizeof(ref));
+        for (int i = 0; i < B2B_MSG_BITS; ++i) {
+            if ((res.syms[i / 6] >> (5 - i % 6)) & 1) ref[i / 8] |= (unsigned char)(0x80u >> (i % 8));
+        }
+        bool refOk = res.nerr >= 0 && b2b_crc24q(ref, 0, B2B_MSG_BITS - 24) == readBits(ref, B2B_MSG_BITS - 24, 24);
+
+        const bool prodFull = _decoded.size() >= B2B_MSG_BYTES;
+        const unsigned char* prod = reinterpret_cast<const unsigned char*>(_decoded.constData());
+        const bool sameBits = prodFull && sameMessage(ref, prod);
+        const bool sameParse = prodFull && sameMessage(b2b::parse(ref), b2b::parse(prod));
+        bool diverged = false;
+        if (refOk) {
+            diverged = !_crcOk || !sameBits || !sameParse;
+        } else if (_crcOk && res.nerr >= 0) {
+            diverged = !sameBits || !sameParse;  // both parity-clean, one fails CRC
+        }
+        if (diverged) {
+            char navHex[B2B_NAV_WORDS * 8 + 1];
+            for (int w = 0; w < B2B_NAV_WORDS; ++w) snprintf(navHex + 8 * w, 9, "%08X", _nav[w]);
+            B2B_TRACE(B2B_TRACE_WARN, "PPPB2b shadow: C%d %u/%u diverges (production crc=%d, reference nerr=%d crc=%d, "
+                      "bits %s, parse %s) raw=%s",
+                      _prn, _week, _tow, _crcOk ? 1 : 0, res.nerr, refOk ? 1 : 0,
+                      sameBits ? "same" : "differ", sameParse ? "same" : "differ", navHex);
+        }
+        // Last: the owner may be destroyed once its final task reports
+        _owner->recordShadowResult(diverged);
+    }
+
+ private:
+    static unsigned int readBits(const unsigned char* buff, int pos, int len) {
+        unsigned int bits = 0;
+        for (int i = 0; i < len; i++) bits = (bits << 1) + ((buff[(pos + i) / 8] >> (7 - (pos + i) % 8)) & 1u);
+        return bits;
+    }
+    static bool sameMessage(const unsigned char* a, const unsigned char* b) {
+        const int full = B2B_MSG_BITS / 8;
+        if (memcmp(a, b, full) != 0) return false;
+        const unsigned char mask = (unsigned char)(0xFF00 >> (B2B_MSG_BITS % 8));
+        return ((a[full] ^ b[full]) & mask) == 0;
+    }
+    // b2b::parse() value-initialises the alternative it fills, so unused
+    // entries and padding compare equal
+    static bool sameMessage(const b2b::Message& a, const b2b::Message& b) {
+        if (a.index() != b.index()) return false;
+        return std::visit([&b](const auto& m) {
+            typedef std::decay_t<decltype(m)> T;
+            return memcmp(&m, &std::get<T>(b), sizeof(T)) == 0;
+        }, a);
+    }
+
+    PPPB2bDecoder* _owner;
+    int            _prn;
+    uint16_t       _week;
+    uint32_t       _tow;
+    quint32        _nav[B2B_NAV_WORDS];
+    QByteArray     _decoded;
+    bool           _crcOk;
+    SBFcoDecoder::Config _limits;
+};
+
+void PPPB2bDecoder::recordCrcFailure(int prn, int rxch) {
+    QMutexLocker locker(&_ldpcStatsMutex);
+    QPair<int, int> key(prn, rxch);
+    if (!_ldpcStats.contains(key)) {
+        b2b_ldpc_stats empty;
+        memset(&empty, 0, sizeof(empty));
+        _ldpcStats.insert(key, empty);
+    }
+    _ldpcStats[key].crcFail++;
+}
+
+void PPPB2bDecoder::recordReceiverCrcPage(int prn, int rxch) {
+    QMutexLocker locker(&_ldpcStatsMutex);
+    QPair<int, int> key(prn, rxch);
+    if (!_ldpcStats.contains(key)) {
+        b2b_ldpc_stats empty;
+        memset(&empty, 0, sizeof(empty));
+        _ldpcStats.insert(key, empty);
+    }
+    _ldpcStats[key].receiverCrc++;
+}
+
+void PPPB2bDecoder::recordLdpcStats(int prn, int rxch, const SBFcoDecoder::DecodeInfo& info, qint64 ns) {
+    QMutexLocker locker(&_ldpcStatsMutex);
+    QPair<int, int> key(prn, rxch);
+    if (!_ldpcStats.contains(key)) {
+        b2b_ldpc_stats empty;
+        memset(&empty, 0, sizeof(empty));
+        _ldpcStats.insert(key, empty);
+    }
+    b2b_ldpc_stats& st = _ldpcStats[key];
+    st.pages++;
+    if (info.copies > 1) st.voted++;
+    if (info.nerr < 0) {
+        st.parityFail++;
+        if (info.truncated) st.truncated++;
+        st.iterHist[B2B_ITER_BINS - 1]++;
+    } else {
+        if (info.iterations == 0) st.fastPath++;
+        st.iterHist[qMin(info.iterations, B2B_ITER_BINS - 2)]++;
+        st.symbolsCorrected += info.symbolsCorrected;
+        st.symHist[qMin(info.symbolsCorrected, B2B_SYM_BINS - 1)]++;
+    }
+    quint64 uns = ns > 0 ? quint64(ns) : 0;
+    st.nsTotal += uns;
+    if (uns > st.nsMax) st.nsMax = uns;
+    int bin = 0;
+    while (bin < B2B_NS_BINS - 1 && (uns >> (bin + 1)) != 0) bin++;
+    st.nsHist[bin]++;
 }
 
 uint16_t PPPB2bDecoder::U2(const uint8_t* p) const { uint16_t u; memcpy(&u,p,2); return u; }
@@ -183,56 +567,6 @@ QString PPPB2bDecoder::svid2prn(quint16 svid) const{
   return QString("UNK_%1").arg(svid);
 }
 
-static QByteArray parseBytesLiteral(const QString& s) {
-  QString t = s;
-  if (t.size() >= 3 && t.startsWith("b'") && t.endsWith("'")) {
-    t = t.mid(2, t.size() - 3);
-  } else if (t.size() >= 3 && t.startsWith("b\"") && t.endsWith("\"")) {
-    t = t.mid(2, t.size() - 3);
-  }
-  QByteArray out;
-  for (int i = 0; i < t.size();) {
-    QChar c = t[i];
-    if (c == '\\' && i + 1 < t.size() && t[i + 1] == 'x') {
-      int j = i + 2;
-      int consumed = 0;
-      int val = 0;
-      while (consumed < 2 && j < t.size()) {
-        QChar hc = t[j];
-        bool hex = (hc >= '0' && hc <= '9') || (hc >= 'a' && hc <= 'f') || (hc >= 'A' && hc <= 'F');
-        if (!hex) break;
-        int hv = QString(hc).toInt(nullptr, 16);
-        val = (val << 4) | hv;
-        ++consumed;
-        ++j;
-      }
-      if (consumed > 0) {
-        out.append(char(val));
-        i = j;
-      } else {
-        ++i;
-      }
-    } else {
-      out.append(char(c.unicode() & 0xFF));
-      ++i;
-    }
-  }
-  return out;
-}
-
-static QString toRawArray(const QByteArray& buf) {
-  QString s;
-  s.reserve(buf.size() * 6 + 32);
-  s += "const uint8_t raw_msg[] = { ";
-  for (int i = 0; i < buf.size(); ++i) {
-    s += "0x";
-    s += QString("%1").arg((unsigned char)buf.at(i), 2, 16, QLatin1Char('0')).toUpper();
-    if (i + 1 < buf.size()) s += ", ";
-  }
-  s += " };";
-  return s;
-}
-
 int PPPB2bDecoder::input(const uint8_t* sbf_block, int len) {
   if (!sbf_block || len < 8) return -1;
   uint16_t id_rev = U2(sbf_block + 4);
@@ -244,6 +578,9 @@ int PPPB2bDecoder::input(const uint8_t* sbf_block, int len) {
   if (type == 4242) {
     return decode_b2b_payload(payload, payload_len);
   }
+  if (type == 4027) {
+    decodeMeasEpoch(payload, payload_len);
+  }
   return 0;
 }
 
@@ -255,7 +592,6 @@ int PPPB2bDecoder::decode_b2b_payload(const uint8_t* payload, int payload_len) {
   uint8_t  CRCp  = *(payload + 7);
   uint8_t  Src   = *(payload + 9);
   uint8_t  RxCh  = *(payload + 11);
-  QString prnMask = svid2prn(SVIDb);
   if (_epochWeek != WNc || _epochTow != TOW) {
     _epochWeek = WNc;
     _epochTow = TOW;
@@ -263,58 +599,126 @@ int PPPB2bDecoder::decode_b2b_payload(const uint8_t* payload, int payload_len) {
     _epochC60Avail = false;
     _epochC61Avail = false;
   }
-  bool isC59 = (prnMask == "C59");
-  bool isC60 = (prnMask == "C60");
-  bool isC61 = (prnMask == "C61");
+  // PPP-B2b GEOs: BeiDou SVIDs 241-243 are C59-C61 (see svid2prn())
+  bool isC59 = (SVIDb == 241);
+  bool isC60 = (SVIDb == 242);
+  bool isC61 = (SVIDb == 243);
   if (isC59 || isC60 || isC61) {
-    QString head = QString("PPPB2b: TOW=%1 WNc=%2 PRN=%3 CRCPassed=%4 Src=%5 RxCh=%6")
-                   .arg(TOW).arg(WNc).arg(svid2prn(SVIDb)).arg((int)CRCp).arg((int)Src).arg((int)RxCh);
-    BNC_CORE->slotMessage(head.toUtf8(), false);
+    B2B_TRACE(B2B_TRACE_DEBUG, "PPPB2b: TOW=%u WNc=%u PRN=C%d CRCPassed=%d Src=%d RxCh=%d",
+              TOW, WNc, SVIDb - 182, CRCp, Src, RxCh);
 
-    const int NAV_WORDS = 31;
+    const int NAV_WORDS = B2B_NAV_WORDS;
     if (payload_len >= 12 + NAV_WORDS * 4) {
-      QString navHex;
-      navHex.reserve(124 * 2);
-      for (int w = 0; w < 31; ++w) {
-        quint32 NBw = U4(payload + 12 + w * 4);
-        navHex += QString("%1").arg(NBw, 8, 16, QLatin1Char('0')).toUpper();
-      }
-      
-      // Check for EC0FC prefix to skip invalid frames
-      if (navHex.startsWith("EC0FC", Qt::CaseInsensitive)) {
-          BNC_CORE->slotMessage("Skipping frame starting with EC0FC", false);
+      quint32 navWords[NAV_WORDS];
+      for (int w = 0; w < NAV_WORDS; ++w) navWords[w] = U4(payload + 12 + w * 4);
+
+      // Skip invalid frames: the first 20 bits (5 hex digits) read EC0FC
+      if ((navWords[0] >> 12) == 0xEC0FCu) {
+          B2B_TRACE(B2B_TRACE_DEBUG, "Skipping frame starting with EC0FC");
           return 1; // Return 1 to continue processing next inputs
       }
 
-      QByteArray decoded = SBFcoDecoder::decode_LDPC_navbitsRaw(navHex.toUtf8());
-      // BNC_CORE->slotMessage(navHex.toUtf8(), false); // Optional: print raw hex
-      
-      // Prepare preview log
-      int previewN = qMin(decoded.size(), 124);
-      QByteArray preview = decoded.left(previewN);
-      QString previewEsc;
-      previewEsc.reserve(preview.size() * 4 + 2);
-      previewEsc += "b'";
-      for (int i = 0; i < preview.size(); ++i) {
-        previewEsc += "\\x";
-        previewEsc += QString("%1").arg((unsigned char)preview.at(i), 2, 16, QLatin1Char('0')).toUpper();
+      // The same GEO page often arrives on several channels/receivers or is
+      // re-sent after a reconnect; serve those copies without another LDPC run.
+      int geoPrn = isC59 ? 59 : (isC60 ? 60 : 61);
+      SBFcoDecoder::DecodeInfo ldpc;
+      QByteArray decoded;
+      // A page the receiver already decoded is systematic: the message is the
+      // leading 486 code bits and needs no LDPC run.
+      bool rxTaken = false;
+      if (_rxCrcBypass && CRCp) {
+        uint8_t msg[B2B_MSG_BYTES];
+        if (b2b_extract_page(navWords, msg) == 0 || !_rxCrcVerify) {
+          decoded = QByteArray(reinterpret_cast<const char*>(msg), B2B_MSG_BYTES);
+          rxTaken = true;
+          recordReceiverCrcPage(geoPrn, RxCh);
+        }
+      }
+      B2bPageCacheEntry* cached = rxTaken ? nullptr : lookupPageCache(geoPrn, WNc, TOW, navWords);
+      bool decodedNow = false;
+      if (cached) {
+        // Still a reception of this page, for the copy count of its set
+        addReception(geoPrn, WNc, TOW, navWords, channelErrProb(geoPrn, RxCh, WNc, TOW));
+        decoded = cached->decoded;
+        ldpc = cached->info;
+      } else if (!rxTaken) {
+        const SBFcoDecoder::Config ldpcCfg = _ldpcBudget.current();
+        const bool reduced = _ldpcBudget.degraded();
+        // Other receptions of this page that have not yet yielded a CRC-clean
+        // decode are voted together with this one before LDPC.
+        // Each copy is weighted by its channel's C/N0 or running error rate.
+        B2bReceptionSet& rs = addReception(geoPrn, WNc, TOW, navWords, channelErrProb(geoPrn, RxCh, WNc, TOW));
+        QElapsedTimer ldpcTimer;
+        ldpcTimer.start();
+        if (rs.ncopies > 1 && !rs.resolved) {
+            std::vector<const uint32_t*> copies;
+            std::vector<double> errProbs;
+            bool weighted = false;
+            for (int c = 0; c < rs.ncopies; ++c) {
+                copies.push_back(rs.nav[c]);
+                errProbs.push_back(rs.errProb[c]);
+                if (rs.errProb[c] > 0.0) weighted = true;
+            }
+            decoded = SBFcoDecoder::decode_LDPC_navWordsVoted(copies, &ldpc, ldpcCfg, weighted ? &errProbs : nullptr);
+        } else {
+            decoded = SBFcoDecoder::decode_LDPC_navWords(navWords, &ldpc, ldpcCfg);
+        }
+        qint64 ldpcNs = ldpcTimer.nsecsElapsed();
+        _ldpcBudget.update(ldpcNs);
+        ldpc.truncated = reduced && ldpc.nerr < 0;
+        recordLdpcStats(geoPrn, RxCh, ldpc, ldpcNs);
+        if (ldpc.copies == 1) updateChannelErrRate(geoPrn, RxCh, ldpc.nerr);
+        if (ldpc.truncated) {
+            // A repeat of this page deserves a decode at full strength
+            B2B_TRACE(B2B_TRACE_WARN, "C%d LDPC page truncated by latency budget (maxIter %d, EMS %d)",
+                      geoPrn, ldpcCfg.maxIter, ldpcCfg.nmEms);
+        }
+        decodedNow = true;
+      }
+
+      bool crcOk = rxTaken || b2b_checkcrc(reinterpret_cast<const unsigned char*>(decoded.constData()), decoded.size());
+      // Only clean decodes are cached: a failed one must be retried, and
+      // voted with, when the next copy of the page arrives
+      if (decodedNow && crcOk && ldpc.nerr >= 0) {
+          storePageCache(geoPrn, WNc, TOW, navWords, decoded, ldpc);
+      }
+      if (_shadowFraction > 0.0 && QRandomGenerator::global()->generateDouble() < _shadowFraction &&
+          reserveShadowSlot()) {
+          b2bShadowPool()->start(new B2bShadowTask(this, geoPrn, WNc, TOW, navWords, decoded, crcOk,
+                                                   _ldpcBudget.current()));
+      }
+
+      // Reject pages whose CRC-24Q fails before any parse, mask or state update
+      if (!crcOk) {
+          recordCrcFailure(geoPrn, RxCh);
+          B2B_TRACE(B2B_TRACE_WARN, "C%d page CRC-24Q failed, dropped", geoPrn);
+          return 1;
+      }
+      B2bReceptionSet& votes = _receptions[geoPrn % B2B_VOTE_SLOTS];
+      if (votes.valid && votes.prn == geoPrn && votes.week == WNc && votes.tow == TOW) votes.resolved = true;
+
+      // Decoded message preview (bits 0..485), formatted only when traced
+      if (B2B_TRACE_ON(B2B_TRACE_VERBOSE)) {
+        static const char HEX[] = "0123456789ABCDEF";
+        char preview[B2B_MSG_BYTES * 2 + 1];
+        int previewN = qMin(decoded.size(), B2B_MSG_BYTES);
+        for (int i = 0; i < previewN; ++i) {
+          unsigned char b = (unsigned char)decoded.at(i);
+          preview[2 * i] = HEX[b >> 4];
+          preview[2 * i + 1] = HEX[b & 0x0F];
+        }
+        preview[2 * previewN] = '\0';
+        B2B_TRACE(B2B_TRACE_VERBOSE, "C%d NAVBits decoded preview (%d bytes): %s", geoPrn, previewN, preview);
       }
-      previewEsc += "'";
-      QString out = QString("%1 NAVBits decoded preview (%2 bytes): %3")
-                      .arg(isC59 ? "C59" : (isC60 ? "C60" : "C61"))
-                      .arg(previewN)
-                      .arg(toRawArray(parseBytesLiteral(previewEsc)));
-      BNC_CORE->slotMessage(out.toUtf8(), false);
 
       // Use the decoded data with the new C-based logic
       if (decoded.size() > 0) {
           if ((isC60 && _epochC59Avail) || (isC61 && (_epochC59Avail || _epochC60Avail))) {
-              BNC_CORE->slotMessage(QString("Skip %1 at epoch due to higher-priority available").arg(isC60 ? "C60" : "C61").toUtf8(), false);
+              B2B_TRACE(B2B_TRACE_DEBUG, "Skip C%d at epoch due to higher-priority available", geoPrn);
               return 1;
           }
-          // Construct Message_header for b2b_parsecorr
+          // The page is parsed straight from the decoded bytes
           struct Message_header mh;
-          memset(&mh, 0, sizeof(mh));
           mh.current_PRN = isC59 ? 59 : (isC60 ? 60 : 61);
           mh.current_week_second.BDSweek = WNc;
           // Note: TOW from SBF is in seconds, but b2b_parsecorr expects BDSsecond/sow logic.
@@ -328,39 +732,36 @@ int PPPB2bDecoder::decode_b2b_payload(const uint8_t* payload, int payload_len) {
           epoTime.set(WNc, TOW);
           _lastTime = epoTime;
 
-          unsigned int year, month, day, hour, min;
-          double sec;
-          _lastTime.civil_date(year, month, day);
-          _lastTime.civil_time(hour, min, sec);
-          int isec = (int)sec;
-          int msec = (int)((sec - isec) * 1000);
-          QDateTime qdt(QDate(year, month, day), QTime(hour, min, isec, msec), Qt::UTC);
-          // BNC_CORE->setDateAndTimeGPS(qdt); // Do not force update system time with SBF time
-
-          // Copy decoded data to mh.data. 
-          // b2b_parsecorr expects raw bytes in mh.data.
-          // Ensure we don't overflow.
-          int copyLen = qMin((int)sizeof(mh.data), decoded.size());
-          memcpy(mh.data, decoded.constData(), copyLen);
+          // The CRC check above guarantees a full message
+          mh.data = reinterpret_cast<const unsigned char*>(decoded.constData());
 
           // Call b2b_parsecorr
           bool res = b2b_parsecorr(&mh);
           if (res) {
              if (isC59) _epochC59Avail = true; else if (isC60) _epochC60Avail = true; else _epochC61Avail = true;
              // Debug Output: Check Time Sync
-             QDateTime sysTime = BNC_CORE->dateAndTimeGPS();
-             QString msg = QString("B2b Time: %1, Sys Time: %2, Diff: %3 s")
-                           .arg(qdt.toString("yyyy-MM-dd HH:mm:ss"))
-                           .arg(sysTime.toString("yyyy-MM-dd HH:mm:ss"))
-                           .arg(sysTime.isValid() ? QString::number(qdt.secsTo(sysTime)) : "N/A");
-             BNC_CORE->slotMessage(msg.toUtf8(), false);
+             if (B2B_TRACE_ON(B2B_TRACE_DEBUG)) {
+               unsigned int year, month, day, hour, min;
+               double sec;
+               _lastTime.civil_date(year, month, day);
+               _lastTime.civil_time(hour, min, sec);
+               int isec = (int)sec;
+               int msec = (int)((sec - isec) * 1000);
+               QDateTime qdt(QDate(year, month, day), QTime(hour, min, isec, msec), Qt::UTC);
+               // BNC_CORE->setDateAndTimeGPS(qdt); // Do not force update system time with SBF time
+               QDateTime sysTime = BNC_CORE->dateAndTimeGPS();
+               QByteArray diff = sysTime.isValid() ? QByteArray::number(qdt.secsTo(sysTime)) : QByteArray("N/A");
+               B2B_TRACE(B2B_TRACE_DEBUG, "B2b Time: %s, Sys Time: %s, Diff: %s s",
+                         qdt.toString("yyyy-MM-dd HH:mm:ss").toUtf8().constData(),
+                         sysTime.toString("yyyy-MM-dd HH:mm:ss").toUtf8().constData(), diff.constData());
+             }
 
              // BNC_CORE->slotMessage(QString("b2b_parsecorr success").toUtf8(), false);
              // After parsing, data is in ssr_orbits and ssr_clocks. 
              // Now trigger integration to BNC core.
              sendResults();
           } else {
-             BNC_CORE->slotMessage(QString("b2b_parsecorr failed").toUtf8(), false);
+             B2B_TRACE(B2B_TRACE_WARN, "b2b_parsecorr failed");
           }
       }
     }
@@ -385,16 +786,12 @@ int PPPB2bDecoder::getbits(const unsigned char *buff, int pos, int len) {
 
 bool PPPB2bDecoder::gnssinit(const char* ssrfile, const char* outfile) {
     // Logic already in constructor, but if needed to reset or re-init
-    memset(ssr_orbits, 0, sizeof(ssr_orbits));
-    memset(ssr_clocks, 0, sizeof(ssr_clocks));
-    memset(ssr_masks, 0, sizeof(ssr_masks));
+    ssr_orbits.reset(ssr_orbits.capacity());
+    ssr_clocks.reset(ssr_clocks.capacity());
+    ssr_masks.reset(ssr_masks.capacity());
     memset(&ssr_config, 0, sizeof(ssr_config));
-    ssr_orbit_count = 0;
-    ssr_clock_count = 0;
-    ssr_mask_count = 0;
 
     // For real-time, these files might not be used directly, but we keep the structure.
-    if (ssrfile) strcpy(ssr_config.CK_FILE[0], ssrfile);
     strcpy(ssr_config.Machine_number, "sz001");
     strcpy(ssr_config.Site_number, "BJ03");
     strcpy(ssr_config.DATA_PPP_FILENAME, "b2b_outfile");
@@ -403,427 +800,258 @@ bool PPPB2bDecoder::gnssinit(const char* ssrfile, const char* outfile) {
     return true;
 }
 
-bool PPPB2bDecoder::b2b_parse_ppp(unsigned char* datapackage, pppdata* PPPB2B) {
-    int b;
-    unsigned int type = getbitu(datapackage, 0, 6);
-    PPPB2B->mestype = type;
-    PPPB2B->BDSsod = getbitu(datapackage, 6, 17);
-    PPPB2B->nudata = getbitu(datapackage, 23, 4);
-    PPPB2B->SSR = getbitu(datapackage, 27, 2);
-    PPPB2B->CRC = getbitu(datapackage, 462, 24);
-    int r = 29, a = 0;
-    if (8 <= PPPB2B->mestype && PPPB2B->mestype <= 63) {
-        return true;
-    }
-    switch (type) {
-    case 1:
-        PPPB2B->type.type1.IODP = getbitu(datapackage, 29, 4);
-        for (a = 0; a < IF_MAXSAT; a++) {
-            PPPB2B->type.type1.prn_make[a] = getbitu(datapackage, 33 + a, 1);
-        }
-        for (a = 0; a < 174; a++) {
-            PPPB2B->type.type1.sub1NULL[a] = getbitu(datapackage, 288 + a, 1);
-        }
-        break;
-    case 2:
-        for (a = 0; a < 6; a++) {
-            PPPB2B->type.type2.trasub[a].satslot = getbitu(datapackage, r, 9); r += 9;
-            PPPB2B->type.type2.trasub[a].IODN = getbitu(datapackage, r, 10); r += 10;
-            PPPB2B->type.type2.trasub[a].IODCorr = getbitu(datapackage, r, 3); r += 3;
-            PPPB2B->type.type2.trasub[a].radial = getbits(datapackage, r, 15) * 0.0016; r += 15;
-            PPPB2B->type.type2.trasub[a].Tangentialdir = getbits(datapackage, r, 13) * 0.0064; r += 13;
-            PPPB2B->type.type2.trasub[a].Normaldir = getbits(datapackage, r, 13) * 0.0064; r += 13;
-            PPPB2B->type.type2.trasub[a].URAclass = getbitu(datapackage, r, 3); r += 3;
-            PPPB2B->type.type2.trasub[a].URAvalue = getbitu(datapackage, r, 3); r += 3;
-            PPPB2B->type.type2.trasub[a].ura = pow(3, PPPB2B->type.type2.trasub[a].URAclass) * (1 + 0.25 * PPPB2B->type.type2.trasub[a].URAvalue) - 1;
-        }
-        PPPB2B->type.type2.sub1NULL = getbitu(datapackage, r, 19);
-        break;
-    case 3:
-        b = 0;
-        PPPB2B->type.type3.num = getbitu(datapackage, r, 5); r += 5;
-        for (a = 0; a < PPPB2B->type.type3.num; a++) {
-            PPPB2B->type.type3.intersub3[a].satslot = getbitu(datapackage, r, 9); r += 9;
-            PPPB2B->type.type3.intersub3[a].num4 = getbitu(datapackage, r, 4); r += 4;
-            for (b = 0; b < PPPB2B->type.type3.intersub3[a].num4; b++) {
-                PPPB2B->type.type3.intersub3[a].pattern[b] = getbitu(datapackage, r, 4); r += 4;
-                PPPB2B->type.type3.intersub3[a].deciation[b] = getbits(datapackage, r, 12) * 0.017; r += 12;
-            }
-        }
-        break;
-    case 4:
-        PPPB2B->type.type4.IODP = getbitu(datapackage, r, 4); r += 4;
-        PPPB2B->type.type4.subtupe1 = getbitu(datapackage, r, 5); r += 5;
-        for (a = 0; a < 23; a++) {
-            PPPB2B->type.type4.IDO_corr[a] = getbitu(datapackage, r, 3); r += 3;
-            PPPB2B->type.type4.c[a] = getbits(datapackage, r, 15) * 0.0016; r += 15;
-        }
-        PPPB2B->type.type4.REV = getbitu(datapackage, r, 10);
-        break;
-    case 5:
-        PPPB2B->type.type5.IODP = getbitu(datapackage, r, 4); r += 4;
-        PPPB2B->type.type5.subtupe2 = getbitu(datapackage, r, 3); r += 3;
-        for (a = 0; a < 70; a++) {
-            PPPB2B->type.type5.URAclass[a] = getbitu(datapackage, r, 3); r += 3;
-            PPPB2B->type.type5.URAvalue[a] = getbitu(datapackage, r, 3); r += 3;
-        }
-        break;
-    case 6:
-        PPPB2B->type.type6.NUMC = getbitu(datapackage, r, 5); r += 5;
-        PPPB2B->type.type6.NUMO = getbitu(datapackage, r, 3); r += 3;
-
-        PPPB2B->type.type6.sub6_clock.toc = getbitu(datapackage, r, 17); r += 17;
-        PPPB2B->type.type6.sub6_clock.DEV = getbitu(datapackage, r, 4); r += 4;
-        PPPB2B->type.type6.sub6_clock.IOD_SSR = getbitu(datapackage, r, 2); r += 2;
-        PPPB2B->type.type6.sub6_clock.IOPD = getbitu(datapackage, r, 4); r += 4;
-        PPPB2B->type.type6.sub6_clock.Slot_S = getbitu(datapackage, r, 9); r += 9;
-        for (a = 0; a < PPPB2B->type.type6.NUMC; a++) {
-            PPPB2B->type.type6.sub6_clock.clock_N_sub6[a].IOD_corr = getbitu(datapackage, r, 3); r += 3;
-            PPPB2B->type.type6.sub6_clock.clock_N_sub6[a].Co = getbitu(datapackage, r, 15); r += 15;
-        }
-        PPPB2B->type.type6.sub6_tarck.tot = getbitu(datapackage, r, 17); r += 17;
-        PPPB2B->type.type6.sub6_tarck.DEV = getbitu(datapackage, r, 4); r += 4;
-        PPPB2B->type.type6.sub6_clock.IOD_SSR = getbitu(datapackage, r, 2); r += 2;
-        for (a = 0; a < PPPB2B->type.type6.NUMO; a++) {
-            PPPB2B->type.type6.sub6_tarck.numO[a].satslot = getbitu(datapackage, r, 9); r += 9;
-            PPPB2B->type.type6.sub6_tarck.numO[a].IODN = getbitu(datapackage, r, 10); r += 10;
-            PPPB2B->type.type6.sub6_tarck.numO[a].IODCorr = getbitu(datapackage, r, 3); r += 3;
-            PPPB2B->type.type6.sub6_tarck.numO[a].radial = getbits(datapackage, r, 15) * 0.0016; r += 15;
-            PPPB2B->type.type6.sub6_tarck.numO[a].Tangentialdir = getbits(datapackage, r, 13) * 0.0064; r += 13;
-            PPPB2B->type.type6.sub6_tarck.numO[a].Normaldir = getbits(datapackage, r, 13) * 0.0064; r += 13;
-            PPPB2B->type.type6.sub6_tarck.numO[a].URAclass = getbitu(datapackage, r, 3); r += 3;
-            PPPB2B->type.type6.sub6_tarck.numO[a].URAvalue = getbitu(datapackage, r, 3); r += 3;
-        }
-        break;
-    case 7:
-        PPPB2B->type.type7.NUMC = getbitu(datapackage, r, 5); r += 5;
-        PPPB2B->type.type7.NUMO = getbitu(datapackage, r, 3); r += 3;
-        PPPB2B->type.type7.sub7_clock.toc = getbitu(datapackage, r, 17); r += 17;
-        PPPB2B->type.type7.sub7_clock.DEV = getbitu(datapackage, r, 4); r += 4;
-        PPPB2B->type.type7.sub7_clock.IOD_SSR = getbitu(datapackage, r, 2); r += 2;
-        for (a = 0; a < PPPB2B->type.type6.NUMC; a++) {
-            PPPB2B->type.type7.sub7_clock.clock_sub7[a].satslot = getbitu(datapackage, r, 9); r += 9;
-            PPPB2B->type.type7.sub7_clock.clock_sub7[a].IOD_corr = getbitu(datapackage, r, 3); r += 3;
-            PPPB2B->type.type7.sub7_clock.clock_sub7[a].Co = getbitu(datapackage, r, 15); r += 15;
-        }
-        PPPB2B->type.type7.sub7_tarck.tot = getbitu(datapackage, r, 17); r += 17;
-        PPPB2B->type.type7.sub7_tarck.DEV = getbitu(datapackage, r, 4); r += 4;
-        PPPB2B->type.type7.sub7_tarck.IOD_SSR = getbitu(datapackage, r, 2); r += 2;
-        for (a = 0; a < PPPB2B->type.type7.NUMO; a++) {
-            PPPB2B->type.type7.sub7_tarck.numO[a].satslot = getbitu(datapackage, r, 9); r += 9;
-            PPPB2B->type.type7.sub7_tarck.numO[a].IODN = getbitu(datapackage, r, 10); r += 10;
-            PPPB2B->type.type7.sub7_tarck.numO[a].IODCorr = getbitu(datapackage, r, 3); r += 3;
-            PPPB2B->type.type7.sub7_tarck.numO[a].radial = getbits(datapackage, r, 15) * 0.0016; r += 15;
-            PPPB2B->type.type7.sub7_tarck.numO[a].Tangentialdir = getbits(datapackage, r, 13) * 0.0064; r += 13;
-            PPPB2B->type.type7.sub7_tarck.numO[a].Normaldir = getbits(datapackage, r, 13) * 0.0064; r += 13;
-            PPPB2B->type.type7.sub7_tarck.numO[a].URAclass = getbitu(datapackage, r, 3); r += 3;
-            PPPB2B->type.type7.sub7_tarck.numO[a].URAvalue = getbitu(datapackage, r, 3); r += 3;
-        }
-        break;
-    default:
-        // printf("parse_PPPB2B  error\n");
-        return false;
-    }
-    return true;
+bool PPPB2bDecoder::b2b_checkcrc(const unsigned char* datapackage, int len) {
+    // CRC-24Q covers message type + data (bits 0..461); the CRC field follows
+    if (len * 8 < B2B_MSG_BITS) return false;
+    return b2b_crc24q(datapackage, 0, B2B_MSG_BITS - 24) == getbitu(datapackage, B2B_MSG_BITS - 24, 24);
+}
+
+b2b::Message PPPB2bDecoder::b2b_parse_ppp(const unsigned char* datapackage) {
+    return b2b::parse(datapackage);
 }
 
 int PPPB2bDecoder::b2b_updateiode(int SSR, int prn, int iodcrc) {
-    for(int i = ssr_orbit_count - 1; i >= (ssr_orbit_count - 7 >= 0 ? ssr_orbit_count - 7 : 0); i--) {
-        if(ssr_orbits[i].SSR != SSR) continue;
-        if(ssr_orbits[i].iodcorr[prn] == iodcrc)
-            return ssr_orbits[i].iode[prn];
+    for(int age = 0; age < qMin(ssr_orbits.size(), 7); age++) {
+        const ppp_ssr_orbit& orbit = ssr_orbits.at(age);
+        if(orbit.SSR != SSR) continue;
+        const ppp_ssr_orbit_sat* sat = orbit.sat.find(prn);
+        if(sat && sat->iodcorr == iodcrc)
+            return sat->iode;
     }
     return -1;
 }
 
-void PPPB2bDecoder::b2b_fillmem(pppdata* p_sbas) {
-    int i, prn, ipos, nsum, bgot;
+void PPPB2bDecoder::b2b_fillmem(const b2b::Message& msg, int week, double sow) {
+    int i, prn;
+    quint64 key;
     ppp_ssr_orbit *ptr_fill = NULL;
     ppp_ssr_mask* ptr_mask = NULL;
     ppp_ssr_clock* ptr_clk = NULL;
 
-    switch(p_sbas->mestype) {
-    case 1:
-        for(i = 0, bgot = false; i < ssr_mask_count; i++) {
-            if(ssr_masks[i].SSR != p_sbas->SSR) continue;
-            if(ssr_masks[i].iodp == p_sbas->type.type1.IODP) {
-                bgot = true;
-            }
-        }
-        if(bgot == false) {
-            if (ssr_mask_count >= IF_MAXMASK) {
-                for (i = 0; i < ssr_mask_count - 1; i++) {
-                    ssr_masks[i] = ssr_masks[i + 1];
+    // MT3 and MT5..MT7 are parsed but not applied
+    if (const b2b::Mt1* m = std::get_if<b2b::Mt1>(&msg)) {
+        if(!ssr_masks.find(b2bMaskKey(m->ssr, m->iodp))) {
+            ptr_mask = &ssr_masks.push(b2bMaskKey(m->ssr, m->iodp));
+
+            ptr_mask->SSR = m->ssr;
+            ptr_mask->iodp = m->iodp;
+            memcpy(ptr_mask->bits, m->prn_mask, sizeof(ptr_mask->bits));
+            ptr_mask->nsat = 0;
+            for (int w = 0; w < 4; w++) {
+                for (uint64_t b = ptr_mask->bits[w]; b; ) {
+                    int k = __builtin_clzll(b);
+                    ptr_mask->slot[ptr_mask->nsat++] = (unsigned char)(w * 64 + k);
+                    b &= ~(0x8000000000000000ull >> k);
                 }
-                ssr_mask_count--;
             }
-            ptr_mask = ssr_masks + ssr_mask_count++;
-
-            ptr_mask->SSR = p_sbas->SSR;
-            ptr_mask->iodp = p_sbas->type.type1.IODP;
-            memcpy(ptr_mask->cmake, p_sbas->type.type1.prn_make, sizeof(char) * IF_MAXSAT);
             
-            BNC_CORE->slotMessage(QString("MT1 MASK: SSR=%1 IODP=%2").arg(ptr_mask->SSR).arg(ptr_mask->iodp).toUtf8(), false);
-            QString mask_str = "BDS MASK content: ";
-            for(int k=0; k<IF_MAXSAT; k++) {
-                if(ptr_mask->cmake[k]) {
-                     int prn = satslot_prn(k + 1); // Assuming index k corresponds to slot k+1
-                     if(syssig_prn(k+1) == 0) { // 0 for 'C' in SYS array
-                         mask_str += QString::number(prn) + " ";
-                     }
+            B2B_TRACE(B2B_TRACE_INFO, "MT1 MASK: SSR=%d IODP=%d", ptr_mask->SSR, ptr_mask->iodp);
+            if (B2B_TRACE_ON(B2B_TRACE_DEBUG)) {
+                char mask_str[B2B_TRACE_STR_BYTES];
+                int len = 0;
+                mask_str[0] = '\0';
+                for(int i=0; i<ptr_mask->nsat; i++) {
+                    int k = ptr_mask->slot[i];
+                    int prn = satslot_prn(k + 1); // Assuming index k corresponds to slot k+1
+                    if(syssig_prn(k+1) == 0 && len < (int)sizeof(mask_str) - 5) { // 0 for 'C' in SYS array
+                        len += snprintf(mask_str + len, sizeof(mask_str) - len, "%d ", prn);
+                    }
                 }
+                B2B_TRACE(B2B_TRACE_DEBUG, "BDS MASK content: %s", mask_str);
             }
-            BNC_CORE->slotMessage(mask_str.toUtf8(), false);
         }
-        break;
-    case 2:
-        ipos = -1;
-        for(i = 0; i < ssr_orbit_count; i++) {
-            if(ssr_orbits[i].SSR != p_sbas->SSR || ssr_orbits[i].bweek != p_sbas->BDSweek || (int)ssr_orbits[i].bsow != p_sbas->BDSsow) continue;
-            ipos = i;
-            break;
-        }
-        ptr_fill = ssr_orbits + ipos;
-        if(-1 == ipos) {
-            if(ssr_orbit_count >= IF_MAXSSR) {
-                for(i = 0; i < ssr_orbit_count - 1; i++) {
-                    ssr_orbits[i] = ssr_orbits[i + 1];
+    } else if (const b2b::Mt2* m = std::get_if<b2b::Mt2>(&msg)) {
+        key = b2bEpochKey(m->ssr, week, (int)sow);
+        ptr_fill = ssr_orbits.find(key);
+        if(ptr_fill == NULL) {
+            ptr_fill = &ssr_orbits.push(key);
+            ptr_fill->bweek = week;
+            ptr_fill->bsow = sow;
+            ptr_fill->SSR = m->ssr;
+            ptr_fill->sat.clear();
+            // The previous epoch of this SSR is complete now
+            if (B2B_TRACE_ON(B2B_TRACE_DEBUG)) {
+                for(i = 1; i < ssr_orbits.size(); i++) {
+                    if(ssr_orbits.at(i).SSR == m->ssr) {
+                        m_outorbit(&ssr_orbits.at(i));
+                        break;
+                    }
                 }
-                ssr_orbit_count--;
-            }
-            ptr_fill = ssr_orbits + ssr_orbit_count++;
-            ptr_fill->bweek = p_sbas->BDSweek;
-            ptr_fill->bsow = p_sbas->BDSsow;
-            ptr_fill->SSR = p_sbas->SSR;
-            for(i = 0; i < IF_MAXSAT; i++) ptr_fill->iodcorr[i] = -1;
-            for(i = 0; i < IF_MAXSAT; i++) ptr_fill->iode[i] = -1;
-            for(i = ssr_orbit_count - 1, nsum = 0; i >= 0; i--) {
-                if(ssr_orbits[i].SSR == p_sbas->SSR)
-                    if(++nsum == 2)
-                        ipos = i;
             }
-            if(nsum >= 2) m_outorbit(&ssr_orbits[ipos]);
         }
         for(i = 0; i < 6; i++) {
-            if(p_sbas->type.type2.trasub[i].ura == 0)
+            const b2b::Orbit& orb = m->sat[i];
+            if(orb.ura == 0)
                 continue;
-            prn = p_sbas->type.type2.trasub[i].satslot - 1;
-            ptr_fill->RAC[prn][0]= p_sbas->type.type2.trasub[i].radial;
-            ptr_fill->RAC[prn][1]= p_sbas->type.type2.trasub[i].Tangentialdir;
-            ptr_fill->RAC[prn][2]= p_sbas->type.type2.trasub[i].Normaldir;
-            ptr_fill->iodcorr[prn] = p_sbas->type.type2.trasub[i].IODCorr;
-            ptr_fill->iode[prn] = p_sbas->type.type2.trasub[i].IODN;
-            ptr_fill->ura[prn] = p_sbas->type.type2.trasub[i].ura;
+            prn = orb.slot - 1;
+            if(prn < 0 || prn >= IF_MAXSAT) continue;
+            ppp_ssr_orbit_sat& sat = ptr_fill->sat.add(prn);
+            sat.rac[0] = orb.radial;
+            sat.rac[1] = orb.along;
+            sat.rac[2] = orb.cross;
+            sat.iodcorr = (signed char)orb.iodcorr;
+            sat.iode = (short)orb.iodn;
+            sat.ura = orb.ura;
+            updateSatOrbit(sat);
         }
-        BNC_CORE->slotMessage(QString("MT2 ORBIT processed for SSR=%1").arg(p_sbas->SSR).toUtf8(), false);
+        B2B_TRACE(B2B_TRACE_INFO, "MT2 ORBIT processed for SSR=%d", m->ssr);
         
         // Trigger immediate signal emission for this message
-        emitCorrections(p_sbas);
-        break;
-    case 3:
-        break;
-    case 4:
-        ipos = -1;
-        for(i = 0; i < ssr_clock_count; i++) {
-            if(ssr_clocks[i].SSR != p_sbas->SSR || ssr_clocks[i].bweek != p_sbas->BDSweek || (int)ssr_clocks[i].bsow != p_sbas->BDSsow) continue;
-            ipos = i;
-            break;
-        }
-        ptr_clk = ssr_clocks + ipos;
-        if(ipos == -1) {
-            if(ssr_clock_count >= IF_MAXSSR) {
-                for(i = 0; i < ssr_clock_count - 1; i++) {
-                    ssr_clocks[i] = ssr_clocks[i + 1];
+        emitCorrections(2);
+    } else if (const b2b::Mt4* m = std::get_if<b2b::Mt4>(&msg)) {
+        key = b2bEpochKey(m->ssr, week, (int)sow);
+        ptr_clk = ssr_clocks.find(key);
+        if(ptr_clk == NULL) {
+            ptr_clk = &ssr_clocks.push(key);
+            ptr_clk->SSR = m->ssr;
+            ptr_clk->bweek = week;
+            ptr_clk->bsow = sow;
+            ptr_clk->iodp = m->iodp;
+            ptr_clk->sat.clear();
+            /*for(i = 1; i < ssr_clocks.size(); i++) {
+                if(ssr_clocks.at(i).SSR == m->ssr) {
+                    m_outclock(&ssr_clocks.at(i));
+                    break;
                 }
-                ssr_clock_count--;
-            }
-            ptr_clk = ssr_clocks + ssr_clock_count++;
-            ptr_clk->SSR = p_sbas->SSR;
-            ptr_clk->bweek = p_sbas->BDSweek;
-            ptr_clk->bsow = p_sbas->BDSsow;
-            ptr_clk->iodp = p_sbas->type.type4.IODP;
-            for(i = 0; i < IF_MAXSAT; i++) ptr_clk->iode[i] = -1;
-            for(i = 0; i < IF_MAXSAT; i++) ptr_clk->iodcorr[i] = -1;
-            /*for(i = ssr_clock_count - 1, nsum = 0; i >= 0; i--) {
-                if(ssr_clocks[i].SSR == p_sbas->SSR)
-                    if(++nsum == 2)
-                        ipos = i;
-            }
-            if(nsum >= 2) m_outclock(&ssr_clocks[ipos]);*/
+            }*/
         }
-        for(i = 0, ptr_mask = NULL; i < ssr_mask_count; i++) {
-            if(ssr_masks[i].iodp == ptr_clk->iodp) {
-                ptr_mask = ssr_masks + i;
-                break;
-            }
+        // Mask with this IODP, preferably from the clock's own SSR
+        ptr_mask = ssr_masks.find(b2bMaskKey(ptr_clk->SSR, ptr_clk->iodp));
+        for(i = 0; i < 4 && ptr_mask == NULL; i++) {
+            ptr_mask = ssr_masks.find(b2bMaskKey(i, ptr_clk->iodp));
         }
         for(i = 0; i < 23 && ptr_mask != NULL; i++) {
-            prn = subtype_prn(ptr_mask->cmake, p_sbas->type.type4.subtupe1, i+1);
+            prn = subtype_prn(ptr_mask, m->subtype, i+1);
             if(prn == -1) continue;
-            ptr_clk->C0[prn] = p_sbas->type.type4.c[i];
-            if(fabs(fabs(ptr_clk->C0[prn]) - 26.2128) < 0.01) continue;
-            ptr_clk->iodcorr[prn] = p_sbas->type.type4.IDO_corr[i];
-            ptr_clk->iode[prn] = b2b_updateiode(ptr_clk->SSR, prn, ptr_clk->iodcorr[prn]);
-            {
-              double dClk = ptr_clk->C0[prn] / t_CST::c;
+            ppp_ssr_clock_sat& sat = ptr_clk->sat.add(prn);
+            sat.C0 = m->c0[i];
+            if(fabs(fabs(sat.C0) - 26.2128) < 0.01) {
+                updateSatClock(sat, false);  // clock flagged unavailable
+                continue;
+            }
+            sat.iodcorr = (signed char)m->iodcorr[i];
+            sat.iode = (short)b2b_updateiode(ptr_clk->SSR, prn, sat.iodcorr);
+            updateSatClock(sat, true);
+            if (B2B_TRACE_ON(B2B_TRACE_VERBOSE)) {
+              double dClk = sat.C0 / t_CST::c;
               int sysIdx = syssig_prn(prn + 1);
               char sysCh = (sysIdx==0?'C':(sysIdx==1?'G':(sysIdx==2?'E':(sysIdx==3?'R':'?'))));
               int prnNum = satslot_prn(prn + 1);
-              QString clkMsg = QString("CLK Corr: %1%2 C0=%3 m dClk=%4 s IOD=%5")
-                                .arg(sysCh)
-                                .arg(prnNum, 2, 10, QLatin1Char('0'))
-                                .arg(ptr_clk->C0[prn], 0, 'f', 4)
-                                .arg(dClk, 0, 'e', 6)
-                                .arg(ptr_clk->iode[prn]);
-              BNC_CORE->slotMessage(clkMsg.toUtf8(), false);
+              B2B_TRACE(B2B_TRACE_VERBOSE, "CLK Corr: %c%02d C0=%.4f m dClk=%.6e s IOD=%d",
+                        sysCh, prnNum, sat.C0, dClk, sat.iode);
             }
         }
         m_outclock(ptr_clk);
-        BNC_CORE->slotMessage(QString("MT4 CLOCK processed for SSR=%1").arg(p_sbas->SSR).toUtf8(), false);
+        B2B_TRACE(B2B_TRACE_INFO, "MT4 CLOCK processed for SSR=%d", m->ssr);
         
         // Trigger immediate signal emission for this message
-        emitCorrections(p_sbas);
-        break;
-    case 5:
-        break;
-    case 6:
-        break;
-    case 7:
-        break;
-    default:
-        break;
+        emitCorrections(4);
     }
 }
 
 bool PPPB2bDecoder::b2b_parsecorr(struct Message_header* mh) {
     int mjd, week, i;
-    double sow;
-    pppdata p_sbas = {0};
+    double sow, sod;
     // In real-time stream, TOW/Week from SBF header is usually reliable.
     // Original code used a search loop around mjd because file data might lack context or have jumps.
     // For real-time, we trust the SBF time but should still be careful about week rollovers if needed.
     // However, the loop search logic relies on checking if 'ddif' is small.
     // We will keep the logic but optimize for the fact we already have current week/sow.
     
-    p_sbas.BDSsow = mh->current_week_second.BDSsecond;
-    p_sbas.BDSweek = mh->current_week_second.BDSweek;
-    wksow2mjd(p_sbas.BDSweek, p_sbas.BDSsow, &mjd, &p_sbas.BDSsod);
-    p_sbas.prn = mh->current_PRN;
+    double BDSsow = mh->current_week_second.BDSsecond;
+    int BDSweek = mh->current_week_second.BDSweek;
+    wksow2mjd(BDSweek, BDSsow, &mjd, &sod);
 
-    // Parse the payload bits first
-    if(b2b_parse_ppp(mh->data, &p_sbas)) {
+    // Parse the payload bits first; the message carries its own second of day
+    const b2b::Message msg = b2b_parse_ppp(mh->data);
+    if(const b2b::Header* hdr = b2b::header(msg)) {
+        sod = hdr->sod;
         // Time consistency check (optional for real-time if we trust SBF timestamp)
         // The original loop checks if the decoded time matches the header time within half a week.
         // Since SBF provides explicit WNc (Week Number) and TOW, we might not need to search +/- 1 day/week unless there's ambiguity.
         // We'll keep the check but prioritize the provided week.
         
         for(i = -1; i < 1; i++) {
-            mjd2wksow(mjd + i, p_sbas.BDSsod, &week, &sow);
-            double ddif = (week - p_sbas.BDSweek) * 86400 * 7 + sow - p_sbas.BDSsow;
+            mjd2wksow(mjd + i, sod, &week, &sow);
+            double ddif = (week - BDSweek) * 86400 * 7 + sow - BDSsow;
             if(fabs(ddif) < 43200) {
                 break;
             }
         }
-        mjd2wksow(mjd + i, p_sbas.BDSsod, &p_sbas.BDSweek, &p_sbas.BDSsow);
+        mjd2wksow(mjd + i, sod, &week, &sow);
         
-        b2b_fillmem(&p_sbas);
+        b2b_fillmem(msg, week, sow);
         return true;
     }
     return false;
 }
 
-int PPPB2bDecoder::subtype_prn(char* make, int subtype, int ix) {
-    int i, ipos = subtype * 23 + ix, b = 0;
-    for(i = 0; i < IF_MAXSAT; i++) {
-        if(make[i] == 1) b++;
-        if(b == ipos) return i;
-    }
-    return -1;
+int PPPB2bDecoder::subtype_prn(const ppp_ssr_mask* mask, int subtype, int ix) {
+    int ipos = subtype * 23 + ix;  // 1-based position among the masked satellites
+    return 1 <= ipos && ipos <= mask->nsat ? mask->slot[ipos - 1] : -1;
 }
 
 void PPPB2bDecoder::m_outorbit(ppp_ssr_orbit* orbit) {
     // Placeholder for outputting orbit to BNC console instead of file
+    if (!B2B_TRACE_ON(B2B_TRACE_DEBUG)) return;
     int nsum = 0, week, iyear, imonth, iday, ih, im, mjd, nsat = 0;
     double dsec, sod;
     char SYS[4] = {'C','G','E','R'};
     week = orbit->bweek + 1356.0; // Adjust to GPS week if needed? Original code had this.
     wksow2mjd(week, orbit->bsow, &mjd, &sod);
     mjd2date(mjd, sod, &iyear, &imonth, &iday, &ih, &im, &dsec);
-    for(int isat = 0; isat < IF_MAXSAT; isat++) {
-        if(orbit->iode[isat] == -1) continue;
+    for(const ppp_ssr_orbit_sat& sat : orbit->sat.sats) {
+        if(sat.iode == -1) continue;
         nsat++;
     }
     
-    QString header = QString("> ORBIT %1 %2 %3 %4 %5 %6 %7 %8 CLK01")
-        .arg(iyear, 4, 10, QLatin1Char('0'))
-        .arg(imonth, 2, 10, QLatin1Char('0'))
-        .arg(iday, 2, 10, QLatin1Char('0'))
-        .arg(ih, 2, 10, QLatin1Char('0'))
-        .arg(im, 2, 10, QLatin1Char('0'))
-        .arg(dsec, 4, 'f', 1)
-        .arg(2)
-        .arg(nsat);
-    BNC_CORE->slotMessage(header.toUtf8(), false);
+    B2B_TRACE(B2B_TRACE_DEBUG, "> ORBIT %04d %02d %02d %02d %02d %4.1f %d %d CLK01",
+              iyear, imonth, iday, ih, im, dsec, 2, nsat);
+    if (!B2B_TRACE_ON(B2B_TRACE_VERBOSE)) return;
 
     for(int isat = 0; isat < IF_MAXSAT; isat++) {
-        if(orbit->iode[isat] == -1) continue;
+        const ppp_ssr_orbit_sat* sat = orbit->sat.find(isat);
+        if(!sat || sat->iode == -1) continue;
         int sysIdx = syssig_prn(isat + 1);
         if (sysIdx < 0) continue;
         if (SYS[sysIdx] == 'C') {
-             BNC_CORE->slotMessage(QString("BDS ORB: PRN=%1 IODN=%2 IODCorr=%3").arg(satslot_prn(isat + 1)).arg(orbit->iode[isat]).arg(orbit->iodcorr[isat]).toUtf8(), false);
+             B2B_TRACE(B2B_TRACE_VERBOSE, "BDS ORB: PRN=%d IODN=%d IODCorr=%d",
+                       satslot_prn(isat + 1), sat->iode, sat->iodcorr);
         }
-        QString line = QString("%1%2 %3 %4 %5 %6 %7 %8 %9")
-            .arg(SYS[sysIdx])
-            .arg(satslot_prn(isat + 1), 2, 10, QLatin1Char('0'))
-            .arg(orbit->iode[isat], 10)
-            .arg(orbit->RAC[isat][0], 11, 'f', 4)
-            .arg(orbit->RAC[isat][1], 11, 'f', 4)
-            .arg(orbit->RAC[isat][2], 11, 'f', 4)
-            .arg(0.0, 11, 'f', 4)
-            .arg(0.0, 11, 'f', 4)
-            .arg(0.0, 11, 'f', 4);
-        BNC_CORE->slotMessage(line.toUtf8(), false);
+        B2B_TRACE(B2B_TRACE_VERBOSE, "%c%02d %10d %11.4f %11.4f %11.4f %11.4f %11.4f %11.4f",
+                  SYS[sysIdx], satslot_prn(isat + 1), sat->iode,
+                  sat->rac[0], sat->rac[1], sat->rac[2], 0.0, 0.0, 0.0);
     }
 }
 
 void PPPB2bDecoder::m_outclock(ppp_ssr_clock* clock) {
+    if (!B2B_TRACE_ON(B2B_TRACE_DEBUG)) return;
     int week, iyear, imonth, iday, ih, im, nsat = 0, mjd;
     double dsec, sod;
     char SYS[4] = {'C','G','E','R'};
     week = clock->bweek + 1356.0;
     wksow2mjd(week, clock->bsow, &mjd, &sod);
     mjd2date(mjd, sod, &iyear, &imonth, &iday, &ih, &im, &dsec);
-    for(int isat = 0; isat < IF_MAXSAT; isat++) {
-        if(clock->iode[isat] == -1) continue;
+    for(const ppp_ssr_clock_sat& sat : clock->sat.sats) {
+        if(sat.iode == -1) continue;
         nsat++;
     }
     
-    QString header = QString("> CLOCK %1 %2 %3 %4 %5 %6 %7 %8 CLK01")
-        .arg(iyear, 4, 10, QLatin1Char('0'))
-        .arg(imonth, 2, 10, QLatin1Char('0'))
-        .arg(iday, 2, 10, QLatin1Char('0'))
-        .arg(ih, 2, 10, QLatin1Char('0'))
-        .arg(im, 2, 10, QLatin1Char('0'))
-        .arg(dsec, 4, 'f', 1)
-        .arg(2)
-        .arg(nsat);
-    BNC_CORE->slotMessage(header.toUtf8(), false);
+    B2B_TRACE(B2B_TRACE_DEBUG, "> CLOCK %04d %02d %02d %02d %02d %4.1f %d %d CLK01",
+              iyear, imonth, iday, ih, im, dsec, 2, nsat);
+    if (!B2B_TRACE_ON(B2B_TRACE_VERBOSE)) return;
 
     for(int isat = 0; isat < IF_MAXSAT; isat++) {
-        if(clock->iode[isat] == -1) continue;
+        const ppp_ssr_clock_sat* sat = clock->sat.find(isat);
+        if(!sat || sat->iode == -1) continue;
         int sysIdx = syssig_prn(isat + 1);
         if (sysIdx < 0) continue;
         if (SYS[sysIdx] == 'C') {
-             BNC_CORE->slotMessage(QString("BDS CLK: PRN=%1 IODP=%2 IODCorr=%3").arg(satslot_prn(isat + 1)).arg(clock->iodp).arg(clock->iodcorr[isat]).toUtf8(), false);
+             B2B_TRACE(B2B_TRACE_VERBOSE, "BDS CLK: PRN=%d IODP=%d IODCorr=%d",
+                       satslot_prn(isat + 1), clock->iodp, sat->iodcorr);
         }
-        QString line = QString("%1%2 %3 %4 %5 %6")
-            .arg(SYS[sysIdx])
-            .arg(satslot_prn(isat + 1), 2, 10, QLatin1Char('0'))
-            .arg(clock->iode[isat], 10)
-            .arg(clock->C0[isat], 11, 'f', 4)
-            .arg(0.0, 11, 'f', 4)
-            .arg(0.0, 11, 'f', 4);
-        BNC_CORE->slotMessage(line.toUtf8(), false);
+        B2B_TRACE(B2B_TRACE_VERBOSE, "%c%02d %10d %11.4f %11.4f %11.4f",
+                  SYS[sysIdx], satslot_prn(isat + 1), sat->iode, sat->C0, 0.0, 0.0);
     }
 }
 
@@ -844,54 +1072,57 @@ void PPPB2bDecoder::mapOrbitToRTCM3(const ppp_ssr_orbit* b2b_orbit, int satIdx)
 void PPPB2bDecoder::mapClockToRTCM3(const ppp_ssr_clock* b2b_clock, int satIdx) {
 }
 
-void PPPB2bDecoder::emitCorrections(const pppdata* p_sbas) {
-    // Emit corrections based on the message type processed in b2b_fillmem
-    
-    // Determine which structures to use based on p_sbas->SSR
-    ppp_ssr_orbit* current_orbits = NULL;
-    ppp_ssr_clock* current_clocks = NULL;
-    
-    // Find the orbit/clock sets that match the current SSR ID
-    for (int i=0; i<ssr_orbit_count; i++) {
-        if (ssr_orbits[i].SSR == p_sbas->SSR) {
-             current_orbits = &ssr_orbits[i];
-             break;
-        }
+void PPPB2bDecoder::updateSatOrbit(const ppp_ssr_orbit_sat& sat) {
+    B2bSatCorrection& sc = _satCorr[sat.slot];
+    sc.orbValid = true;
+    sc.orbIod = sat.iode;
+    sc.rac[0] = sat.rac[0];
+    sc.rac[1] = sat.rac[1];
+    sc.rac[2] = sat.rac[2];
+    if (!sc.orbDirty) {
+        sc.orbDirty = true;
+        _orbDirty.push_back(sat.slot);
     }
-    for (int i=0; i<ssr_clock_count; i++) {
-        if (ssr_clocks[i].SSR == p_sbas->SSR) {
-             current_clocks = &ssr_clocks[i];
-             break;
-        }
+}
+
+void PPPB2bDecoder::updateSatClock(const ppp_ssr_clock_sat& sat, bool available) {
+    B2bSatCorrection& sc = _satCorr[sat.slot];
+    sc.clkValid = available;
+    sc.clkIod = sat.iode;
+    sc.c0 = sat.C0;
+    if (available && !sc.clkDirty) {
+        sc.clkDirty = true;
+        _clkDirty.push_back(sat.slot);
     }
-    
+}
+
+void PPPB2bDecoder::emitCorrections(int mestype) {
+    // Emit the satellites b2b_fillmem updated since the last call, from
+    // their newest corrections
+    static const char SYS[4] = {'C','G','E','R'};
+
     // If message type is 2 (Orbit), buffer orbit corrections
-    if (p_sbas->mestype == 2 && current_orbits) {
-        for(int isat = 0; isat < IF_MAXSAT; isat++) {
-             if(current_orbits->iode[isat] == -1) continue;
-             
+    if (mestype == 2) {
+        for (int isat : _orbDirty) {
+             B2bSatCorrection& sc = _satCorr[isat];
+             sc.orbDirty = false;
              int sysIdx = syssig_prn(isat + 1);
-             if (sysIdx < 0) continue;
-             
-             char sysCh = ' ';
-             if (sysIdx == 0) sysCh = 'C';
-             else if (sysIdx == 1) sysCh = 'G';
-             else if (sysIdx == 2) sysCh = 'E';
-             else if (sysIdx == 3) sysCh = 'R';
-             
+             if (sysIdx < 0 || !sc.orbValid) continue;
+             char sysCh = SYS[sysIdx];
+
              t_orbCorr orbCorr;
              int prn = satslot_prn(isat + 1);
-             
+
              orbCorr._prn.set(sysCh, prn);
              orbCorr._staID = _staID.toStdString();
-             orbCorr._iod = current_orbits->iode[isat];
+             orbCorr._iod = sc.orbIod;
              orbCorr._time = _lastTime; 
              orbCorr._updateInt = 0; 
              orbCorr._system = sysCh;
              
-             orbCorr._xr[0] = current_orbits->RAC[isat][0]; 
-             orbCorr._xr[1] = current_orbits->RAC[isat][1]; 
-             orbCorr._xr[2] = current_orbits->RAC[isat][2]; 
+             orbCorr._xr[0] = sc.rac[0]; 
+             orbCorr._xr[1] = sc.rac[1]; 
+             orbCorr._xr[2] = sc.rac[2]; 
              
              orbCorr._dotXr[0] = 0.0;
              orbCorr._dotXr[1] = 0.0;
@@ -899,19 +1130,18 @@ void PPPB2bDecoder::emitCorrections(const pppdata* p_sbas) {
              
              _orbBuffer.append(orbCorr);
         }
+        _orbDirty.clear();
     }
     
     // If message type is 4 (Clock), buffer clock corrections
-    if (p_sbas->mestype == 4 && current_clocks) {
-        for(int isat = 0; isat < IF_MAXSAT; isat++) {
+    if (mestype == 4) {
+        for (int isat : _clkDirty) {
+            B2bSatCorrection& sc = _satCorr[isat];
+            sc.clkDirty = false;
             // Accept clock even if IODE is unknown; PPP will handle BDS/G/E/R differently
             int sysIdx = syssig_prn(isat + 1);
-            if (sysIdx < 0) continue;
-
-            char sysCh = 'C';
-            if (sysIdx == 1) sysCh = 'G';
-            else if (sysIdx == 2) sysCh = 'E';
-            else if (sysIdx == 3) sysCh = 'R';
+            if (sysIdx < 0 || !sc.clkValid) continue;
+            char sysCh = SYS[sysIdx];
 
             t_clkCorr clkCorr;
             int prn = satslot_prn(isat + 1);
@@ -921,14 +1151,15 @@ void PPPB2bDecoder::emitCorrections(const pppdata* p_sbas) {
             clkCorr._time = _lastTime;
             clkCorr._updateInt = 0;
 
-            clkCorr._dClk = current_clocks->C0[isat] / t_CST::c;
+            clkCorr._dClk = sc.c0 / t_CST::c;
             clkCorr._dotDClk = 0.0;
             clkCorr._dotDotDClk = 0.0;
 
-            clkCorr._iod = current_clocks->iode[isat];
+            clkCorr._iod = sc.clkIod;
 
             _clkBuffer.append(clkCorr);
         }
+        _clkDirty.clear();
     }
 
     processBufferedCorrections();
@@ -941,12 +1172,8 @@ void PPPB2bDecoder::processBufferedCorrections() {
 
     // Check if 30 seconds have passed since last emit
     if (std::abs(_lastTime - _lastEmitTime) >= 5.0) {
-        printf("B2b emit: orbBuf=%d, clkBuf=%d, at=%.1f\n", _orbBuffer.size(), _clkBuffer.size(), (double)_lastTime.gpssec());
-        QString msg = QString("B2b emit: orbBuf=%1, clkBuf=%2, at=%3")
-                        .arg(_orbBuffer.size())
-                        .arg(_clkBuffer.size())
-                        .arg((double)_lastTime.gpssec(), 0, 'f', 1);
-        BNC_CORE->slotMessage(msg.toUtf8(), false);
+        B2B_TRACE(B2B_TRACE_INFO, "B2b emit: orbBuf=%d, clkBuf=%d, at=%.1f",
+                  _orbBuffer.size(), _clkBuffer.size(), (double)_lastTime.gpssec());
         if (!_orbBuffer.isEmpty()) {
             // Update time for all buffered orbit corrections to current time
             for (int i = 0; i < _orbBuffer.size(); ++i) {
@@ -5,16 +5,25 @@
 #include <vector>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include "rtklib.h"
 #include "satObs.h"
+#include "SBFcoDecoder.h"
+#include "b2b_core.h"
 
 extern "C" {
 # include "clock_orbit_rtcm.h"
 }
 
-#define IF_MAXSAT 255
 #define IF_MAXSSR 120
 #define IF_MAXMASK 16
+#define B2B_PAGE_CACHE_SIZE 64
+#define B2B_VOTE_COPIES 5  /* receptions of one page combined by majority vote */
+#define B2B_VOTE_SLOTS 4   /* reception sets, one per GEO PRN */
+#define B2B_CN0_MAX_AGE 10        /* s: older MeasEpoch C/N0 is not used to weight votes */
+#define B2B_ERR_EST_MIN_PAGES 8   /* parity-clean pages before the running error rate is used */
+#define SBF_SIGNAL_BDS_B2B 34     /* MeasEpoch signal number of BDS B2b */
+#define B2B_SHADOW_MAX_PENDING 4  /* shadow decodes queued per decoder; later samples are skipped */
 
 // Define types to match GNSS_PPP.h but within C++ context or using std types
 typedef signed char INT8S;
@@ -27,176 +36,167 @@ typedef long long INT64S;
 typedef unsigned long long INT64U;
 
 typedef struct {
-    char CK_FILE[255][255];
     char Site_number[20];
     char Machine_number[20];
     FILE* fp_output;
     char DATA_PPP_FILENAME[250];
 } config_t;
 
-typedef struct {
-    short satslot;
-    unsigned char IODN;
-    unsigned char IODCorr;
-    double radial;
-    double Tangentialdir;
-    double Normaldir;
-    unsigned char URAclass;
-    unsigned char URAvalue;
-    double ura;
-} Trackcp;
-
-typedef struct {
-    unsigned char IODP;
-    char prn_make[IF_MAXSAT];
-    char sub1NULL[200];
-} ppp_sub1;
-
-typedef struct {
-    int sub1NULL;
-    Trackcp trasub[6];
-} ppp_sub2;
-
-typedef struct {
-    short satslot;
-    unsigned char num4;
-    unsigned char pattern[16];
-    double deciation[16];
-} Intersymbol_dev;
-
-typedef struct {
-    unsigned char num;
-    Intersymbol_dev intersub3[31];
-} ppp_sub3;
-
-typedef struct {
-    unsigned char IODP;
-    unsigned char subtupe1;
-    unsigned char IDO_corr[23];
-    double c[23];
-    int REV;
-} ppp_sub4;
-
-typedef struct {
-    unsigned char IODP;
-    unsigned char subtupe2;
-    unsigned char URAclass[70];
-    unsigned char URAvalue[70];
-    int REV;
-} ppp_sub5;
-
-typedef struct {
-    unsigned char IOD_corr;
-    int Co;
-} clock_NUMC_sub6;
-
-typedef struct {
-    unsigned int toc;
-    short DEV;
-    unsigned char IOD_SSR;
-    unsigned char IOPD;
-    unsigned char Slot_S;
-    clock_NUMC_sub6 clock_N_sub6[22];
-} clock_su6;
-
-typedef struct {
-    unsigned int tot;
-    short DEV;
-    unsigned char IOD_SSR;
-    Trackcp numO[6];
-} track_su6;
-
-typedef struct {
-    unsigned char NUMC;
-    unsigned char NUMO;
-    track_su6 sub6_tarck;
-    clock_su6 sub6_clock;
-} ppp_sub6;
-
-typedef struct {
-    short satslot;
-    unsigned char IOD_corr;
-    int Co;
-} clock_NUMC_sub7;
-
-typedef struct {
-    unsigned int toc;
-    short DEV;
-    unsigned char IOD_SSR;
-    unsigned char IOPD;
-    unsigned char Slot_S;
-    clock_NUMC_sub7 clock_sub7[22];
-} clock_su7;
-
-typedef struct {
-    unsigned char NUMC;
-    unsigned char NUMO;
-    track_su6 sub7_tarck;
-    clock_su7 sub7_clock;
-} ppp_sub7;
-
-union ppp_sub_union {
-    ppp_sub1 type1;
-    ppp_sub2 type2;
-    ppp_sub3 type3;
-    ppp_sub4 type4;
-    ppp_sub5 type5;
-    ppp_sub6 type6;
-    ppp_sub7 type7;
-};
-
-typedef struct {
-    short mestype;
-    int CRC;
-    short nudata;
-    unsigned char SSR;
-    short prn;
-    int BDSweek;
-    double BDSsod;
-    double BDSsow;
-    union ppp_sub_union type;
-    unsigned char sta[10240];
-} pppdata;
-
 struct week_second {
     unsigned short BDSweek;
     INT32U BDSsecond;
 };
 
+// A decoded page and where it came from; data points at its B2B_MSG_BYTES
+// message bytes, which are parsed in place
 struct Message_header {
     struct week_second current_week_second;
     unsigned short current_PRN;
     unsigned char current_sin_s;
     char current_mess_sys;
-    unsigned char data[1024];
+    const unsigned char* data;
+};
+
+// Corrections of one epoch, kept only for the satellites that have one:
+// index[slot] is the entry's position + 1, 0 = none. clear() keeps the
+// entry storage, so a reused history slot does not allocate again.
+template<typename Sat>
+struct B2bEpochSats {
+    unsigned char    index[IF_MAXSAT] = {};
+    std::vector<Sat> sats;
+
+    void clear() {
+        memset(index, 0, sizeof(index));
+        sats.clear();
+    }
+    const Sat* find(int slot) const {
+        return index[slot] ? &sats[index[slot] - 1] : nullptr;
+    }
+    // Entry of slot, appended with unknown IODs if not present yet
+    Sat& add(int slot) {
+        if (!index[slot]) {
+            Sat sat = Sat();
+            sat.slot = (unsigned char)slot;
+            sat.iode = -1;
+            sat.iodcorr = -1;
+            sats.push_back(sat);
+            index[slot] = (unsigned char)sats.size();
+        }
+        return sats[index[slot] - 1];
+    }
 };
 
+// Floats hold the broadcast values exactly enough: the LSBs are 0.0016 m
+// (radial, C0) and 0.0064 m (along, cross) over a range of +-26 m.
 typedef struct {
+    unsigned char slot;     // satellite slot - 1
+    signed char   iodcorr;  // -1 = none
+    short         iode;     // IODN, -1 = unknown
+    float         rac[3];   // radial, along, cross (m)
+    float         ura;      // mm
+} ppp_ssr_orbit_sat;
+
+struct ppp_ssr_orbit {
     int SSR;
     int bweek;
     double bsow;
-    double RAC[IF_MAXSAT][3];
-    double ura[IF_MAXSAT];
-    int iode[IF_MAXSAT];
-    int iodcorr[IF_MAXSAT];
-} ppp_ssr_orbit;
+    B2bEpochSats<ppp_ssr_orbit_sat> sat;
+};
 
 typedef struct {
+    unsigned char slot;     // satellite slot - 1
+    signed char   iodcorr;  // -1 = none
+    short         iode;     // IODN of the matching orbit, -1 = unknown
+    float         C0;       // m
+} ppp_ssr_clock_sat;
+
+struct ppp_ssr_clock {
     int SSR;
     int iodp;
     int bweek;
     double bsow;
-    double C0[IF_MAXSAT];
-    int iode[IF_MAXSAT];
-    int iodcorr[IF_MAXSAT];
-} ppp_ssr_clock;
+    B2bEpochSats<ppp_ssr_clock_sat> sat;
+};
 
+// MT1 mask as a bitset plus its select index: slot[i] is the 0-based slot
+// of the (i+1)-th masked satellite, built once when the mask arrives.
 typedef struct {
     int SSR;
     int iodp;
-    char cmake[IF_MAXSAT];
+    uint64_t bits[4];
+    int nsat;
+    unsigned char slot[IF_MAXSAT];
 } ppp_ssr_mask;
 
+// Fixed-capacity history of per-epoch records. A full history reuses its
+// oldest slot, and records are found by key through a hash index, so
+// neither insertion nor lookup costs more with a deeper history.
+template<typename T>
+class B2bHistory {
+ public:
+    void reset(int capacity) {
+        _items.assign(qMax(capacity, 1), T());
+        _keys.assign(_items.size(), 0);
+        _index.clear();
+        _index.reserve(int(_items.size()));
+        _head = 0;
+        _count = 0;
+    }
+    int size() const { return _count; }
+    int capacity() const { return int(_items.size()); }
+    // age 0 is the newest record, size() - 1 the oldest
+    T& at(int age) {
+        int slot = _head - 1 - age;
+        return _items[slot < 0 ? slot + capacity() : slot];
+    }
+    T* find(quint64 key) {
+        int slot = _index.value(key, -1);
+        return slot < 0 ? nullptr : &_items[slot];
+    }
+    // Slot for a record under a key not yet present, evicting the oldest
+    // record when full; the caller fills it in
+    T& push(quint64 key) {
+        int slot = _head;
+        if (_count == capacity()) {
+            if (_index.value(_keys[slot], -1) == slot) _index.remove(_keys[slot]);
+        } else {
+            _count++;
+        }
+        _keys[slot] = key;
+        _index.insert(key, slot);
+        _head = (_head + 1) % capacity();
+        return _items[slot];
+    }
+
+ private:
+    std::vector<T>       _items;
+    std::vector<quint64> _keys;
+    QHash<quint64, int>  _index;
+    int                  _head = 0;
+    int                  _count = 0;
+};
+
+#define B2B_ITER_BINS 17   /* iterations 0..15, last bin = parity failure */
+#define B2B_SYM_BINS  17   /* symbols corrected 0..15, last bin = 16 or more */
+#define B2B_NS_BINS   32   /* bin k counts decodes taking [2^k, 2^(k+1)) ns */
+
+// LDPC decoder telemetry for one (GEO PRN, receiver channel) pair
+typedef struct {
+    quint64 pages;
+    quint64 fastPath;          // settled by the hard-decision fast path
+    quint64 parityFail;        // parity still failing after MAX_ITER
+    quint64 crcFail;           // CRC-24Q failed after LDPC, page dropped
+    quint64 truncated;         // parity failed while the latency budget had lowered the limits
+    quint64 voted;             // decoded from two or more receptions combined by majority vote
+    quint64 receiverCrc;       // taken as flagged CRC-passed by the receiver, no LDPC run
+    quint64 symbolsCorrected;
+    quint64 nsTotal;
+    quint64 nsMax;
+    quint64 iterHist[B2B_ITER_BINS];
+    quint64 symHist[B2B_SYM_BINS];
+    quint64 nsHist[B2B_NS_BINS];
+} b2b_ldpc_stats;
+
 class PPPB2bDecoder : public QObject
 {
     Q_OBJECT
@@ -206,24 +206,101 @@ class PPPB2bDecoder : public QObject
 
     int input(const uint8_t* sbf_block, int len);
     void setStaID(const QString& staID);
-    void setVerboseSatPrint(bool enabled);
+    // Process-wide: sets the shared B2B_TRACE level to VERBOSE, or back to
+    // INFO, for every decoder
+    static void setVerboseSatPrint(bool enabled);
+
+    // LDPC telemetry keyed by (GEO PRN, receiver channel)
+    QMap<QPair<int, int>, b2b_ldpc_stats> ldpcStats() const;
+    void resetLdpcStats();
+    // Duplicate-page cache counters (pages served without an LDPC run)
+    void pageCacheStats(quint64& hits, quint64& misses) const;
+    // LDPC limits for this instance; the defaults match SBFcoDecoder::Config
+    void setLdpcConfig(const SBFcoDecoder::Config& config);
+    SBFcoDecoder::Config ldpcConfig() const;
+    // Per-page decode time budget in ns (0 = off): when exceeded on average,
+    // the iteration cap and EMS width are lowered and later restored
+    void setLdpcBudgetNs(qint64 budgetNs);
+    // Shadow verification: this fraction (0..1) of decoded pages is decoded
+    // again by SBFcoDecoder::decode_page_reference(), with the current LDPC
+    // limits, on a background thread shared by all decoders; divergences in
+    // the message bits or their parse are logged with the raw page. Samples
+    // beyond B2B_SHADOW_MAX_PENDING queued decodes are skipped.
+    void setShadowVerifyFraction(double fraction);
+    void shadowVerifyStats(quint64& checked, quint64& diverged) const;
+    // Pages the receiver flags CRCPassed skip LDPC and take the message from
+    // the systematic bits. With verifyCrc the local CRC-24Q must match too,
+    // otherwise the page is decoded as usual.
+    void setReceiverCrcBypass(bool enabled, bool verifyCrc = true);
+    // Epochs of orbit and clock corrections kept per decoder (default
+    // IF_MAXSSR); clears the stored history
+    void setCorrectionHistoryDepth(int epochs);
 
 private:
     uint16_t U2(const uint8_t* p) const;
     uint32_t U4(const uint8_t* p) const;
     QString svid2prn(quint16 svid) const;
     int decode_b2b_payload(const uint8_t* payload, int payload_len);
+    void recordLdpcStats(int prn, int rxch, const SBFcoDecoder::DecodeInfo& info, qint64 ns);
+    void recordCrcFailure(int prn, int rxch);
+    void recordReceiverCrcPage(int prn, int rxch);
+    bool reserveShadowSlot();
+    void recordShadowResult(bool diverged);
+    friend class B2bShadowTask;
+
+    // CRC-clean decoded pages keyed by (GEO PRN, WNc, TOW, raw NAVBits), direct-mapped
+    struct B2bPageCacheEntry {
+        bool                     valid = false;
+        quint64                  hash = 0;
+        int                      prn = 0;
+        uint16_t                 week = 0;
+        uint32_t                 tow = 0;
+        quint32                  nav[B2B_NAV_WORDS];
+        QByteArray               decoded;
+        SBFcoDecoder::DecodeInfo info;
+    };
+    B2bPageCacheEntry* lookupPageCache(int prn, uint16_t week, uint32_t tow, const quint32* nav);
+    void storePageCache(int prn, uint16_t week, uint32_t tow, const quint32* nav,
+                        const QByteArray& decoded, const SBFcoDecoder::DecodeInfo& info);
+
+    // Differing receptions (RxCh/Src) of one page, kept until a copy passes
+    // CRC-24Q; a copy with the same bits as one already held is not added
+    struct B2bReceptionSet {
+        bool                     valid = false;
+        bool                     resolved = false;  // a decode of this page passed CRC-24Q
+        int                      prn = 0;
+        uint16_t                 week = 0;
+        uint32_t                 tow = 0;
+        int                      ncopies = 0;
+        quint32                  nav[B2B_VOTE_COPIES][B2B_NAV_WORDS];
+        double                   errProb[B2B_VOTE_COPIES];  // channel bit error probability, 0 = unknown
+    };
+    B2bReceptionSet& addReception(int prn, uint16_t week, uint32_t tow, const quint32* nav, double errProb);
+
+    // Reliability of one (GEO PRN, receiver channel): the latest B2b C/N0
+    // from MeasEpoch and a running bit error rate of its corrected pages
+    struct B2bChannelQuality {
+        double                   cn0 = 0.0;      // dB-Hz, 0 = not seen
+        uint16_t                 cn0Week = 0;
+        uint32_t                 cn0Tow = 0;
+        double                   errRate = 0.0;  // smoothed corrected bits / LDPC bits
+        int                      pages = 0;
+    };
+    void decodeMeasEpoch(const uint8_t* payload, int payload_len);
+    void updateChannelErrRate(int prn, int rxch, int nerr);
+    double channelErrProb(int prn, int rxch, uint16_t week, uint32_t tow) const;
 
     // Adapted from b2b-decoder.c
     bool gnssinit(const char* ssrfile, const char* outfile);
-    bool b2b_parse_ppp(unsigned char* datapackage, pppdata* PPPB2B);
+    bool b2b_checkcrc(const unsigned char* datapackage, int len);
+    b2b::Message b2b_parse_ppp(const unsigned char* datapackage);
     int b2b_updateiode(int SSR, int prn, int iodcrc);
-    void b2b_fillmem(pppdata* p_sbas);
+    void b2b_fillmem(const b2b::Message& msg, int week, double sow);
     bool b2b_parsecorr(struct Message_header* mh);
     // Helper functions from GNSS_PPP.h/b2b-decoder.c logic
     unsigned int getbitu(const unsigned char *buff, int pos, int len);
     int getbits(const unsigned char *buff, int pos, int len);
-    int subtype_prn(char* make, int subtype, int ix);
+    int subtype_prn(const ppp_ssr_mask* mask, int subtype, int ix);
     void m_outorbit(ppp_ssr_orbit* orbit);
     void m_outclock(ppp_ssr_clock* clock);
     void wksow2mjd(int week, double sow, int* mjd, double* sod);
@@ -231,12 +308,9 @@ private:
     
     // Member variables for state
     config_t ssr_config;
-    int ssr_clock_count;
-    int ssr_orbit_count;
-    int ssr_mask_count;
-    ppp_ssr_orbit ssr_orbits[IF_MAXSSR];
-    ppp_ssr_clock ssr_clocks[IF_MAXSSR];
-    ppp_ssr_mask ssr_masks[IF_MAXMASK];
+    B2bHistory<ppp_ssr_orbit> ssr_orbits;  // keyed by b2bEpochKey()
+    B2bHistory<ppp_ssr_clock> ssr_clocks;  // keyed by b2bEpochKey()
+    B2bHistory<ppp_ssr_mask>  ssr_masks;   // keyed by b2bMaskKey()
 
     // Integration with BNC Core - similar to RTCM3coDecoder
     ClockOrbit                            _clkOrb;
@@ -246,9 +320,42 @@ private:
     QMap<bncTime, QList<t_orbCorr> >      _orbCorrections;
     QMap<bncTime, QList<t_clkCorr> >      _clkCorrections;
     QMap<t_prn, t_clkCorr>                _lastClkCorrections;
+    QMap<QPair<int, int>, b2b_ldpc_stats> _ldpcStats;
+    mutable QMutex                        _ldpcStatsMutex;
+    SBFcoDecoder::LatencyBudget           _ldpcBudget;
+    B2bPageCacheEntry                     _pageCache[B2B_PAGE_CACHE_SIZE];
+    quint64                               _pageCacheHits;
+    quint64                               _pageCacheMisses;
+    B2bReceptionSet                       _receptions[B2B_VOTE_SLOTS];
+    QMap<QPair<int, int>, B2bChannelQuality> _channelQuality;
+    bool                                  _rxCrcBypass;
+    bool                                  _rxCrcVerify;
+    double                                _shadowFraction;
+    quint64                               _shadowChecked;   // guarded by _ldpcStatsMutex
+    quint64                               _shadowDiverged;  // guarded by _ldpcStatsMutex
+    int                                   _shadowPending;   // guarded by _ldpcStatsMutex
+    QWaitCondition                        _shadowIdle;      // _shadowPending dropped to 0
+
+    // Newest orbit and clock of one satellite slot, whichever epoch record
+    // they were written to; dirty until the next emitCorrections()
+    struct B2bSatCorrection {
+        bool                     orbValid = false;
+        bool                     orbDirty = false;
+        int                      orbIod = -1;
+        double                   rac[3] = {0.0, 0.0, 0.0};
+        bool                     clkValid = false;
+        bool                     clkDirty = false;
+        int                      clkIod = -1;
+        double                   c0 = 0.0;
+    };
+    B2bSatCorrection                      _satCorr[IF_MAXSAT];
+    std::vector<int>                      _orbDirty;  // slots with a new orbit since the last emit
+    std::vector<int>                      _clkDirty;  // slots with a new clock since the last emit
+    void updateSatOrbit(const ppp_ssr_orbit_sat& sat);
+    void updateSatClock(const ppp_ssr_clock_sat& sat, bool available);
 
     void sendResults();
-    void emitCorrections(const pppdata* p_sbas);
+    void emitCorrections(int mestype);
     void mapOrbitToRTCM3(const ppp_ssr_orbit* b2b_orbit, int satIdx);
     void mapClockToRTCM3(const ppp_ssr_clock* b2b_clock, int satIdx);
     void processBufferedCorrections();
@@ -268,6 +375,4 @@ private:
     void newClkCorrections(QList<t_clkCorr>);
 };
 
-extern bool g_b2bDebugSatPrint;
-
 #endif
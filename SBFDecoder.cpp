@@ -14,7 +14,6 @@ static const unsigned char SBF_SYNC2 = 0x40; // '@'
 SBFDecoder::SBFDecoder(const QByteArray &staID) : _staID(staID) {
   _b2bDec = new PPPB2bDecoder();
   if (_b2bDec) _b2bDec->setStaID(_staID);
-  if (_b2bDec) _b2bDec->setVerboseSatPrint(false);
 }
 SBFDecoder::~SBFDecoder() {
   delete _b2bDec;
@@ -41,17 +40,6 @@ static unsigned getbitu_be(const uint8_t* buff, int pos, int len) {
   }
   return bits;
 }
-static uint32_t crc24q_bits_be(const uint8_t* p, int pos, int len_bits) {
-  uint32_t crc = 0;
-  for (int i = 0; i < len_bits; ++i) {
-    int byte = (pos + i) >> 3;
-    int bit  = 7 - ((pos + i) & 7);
-    uint32_t inb = (p[byte] >> bit) & 1u;
-    crc = ((crc << 1) & 0xFFFFFFu) | inb;
-    if (crc & 0x1000000u) crc ^= 0x1864CFBu;
-  }
-  return crc & 0xFFFFFFu;
-}
 static quint32 U4BE(const unsigned char* p) {
   return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
 }
@@ -0,0 +1,148 @@
+#include "SBFcoBench.h"
+#include "SBFcoDecoder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+namespace {
+// Scalar engine/schedule pairs exercised by the benchmark and the check.
+struct BenchVariant {
+  const char* name;
+  SBFcoDecoder::Engine engine;
+  SBFcoDecoder::Schedule schedule;
+};
+const BenchVariant BENCH_VARIANTS[] = {
+  {"ems-flooding", SBFcoDecoder::ENGINE_EMS, SBFcoDecoder::SCHEDULE_FLOODING},
+  {"ems-layered", SBFcoDecoder::ENGINE_EMS, SBFcoDecoder::SCHEDULE_LAYERED},
+  {"minmax-flooding", SBFcoDecoder::ENGINE_MIN_MAX, SBFcoDecoder::SCHEDULE_FLOODING},
+  {"minmax-layered", SBFcoDecoder::ENGINE_MIN_MAX, SBFcoDecoder::SCHEDULE_LAYERED},
+};
+
+void makePages(const SBFcoBenchConfig& cfg, std::vector<SBFcoDecoder::Page>& sent,
+               std::vector<SBFcoDecoder::Page>& recv) {
+  std::mt19937 rng(cfg.seed);
+  std::uniform_real_distribution<double> uni(0.0, 1.0);
+  sent.resize(cfg.pages);
+  recv.resize(cfg.pages);
+  for (int p = 0; p < cfg.pages; ++p) {
+    uint8_t info[81];
+    for (int i = 0; i < 81; ++i) info[i] = uint8_t(rng() & 0x3F);
+    SBFcoDecoder::encode_BCNV3(info, sent[p].syms);
+    recv[p] = sent[p];
+    for (int i = 0; i < 162; ++i) {
+      if (uni(rng) < cfg.symbolErrorRate) recv[p].syms[i] ^= uint8_t(1 + rng() % 63);
+      for (int b = 0; b < 6; ++b) {
+        if (uni(rng) < cfg.bitErrorRate) recv[p].syms[i] ^= uint8_t(1 << b);
+      }
+    }
+  }
+}
+
+// A decoded result must be a codeword whose nerr is its distance to the input.
+bool resultConsistent(const SBFcoDecoder::Page& recv, const SBFcoDecoder::Result& res) {
+  if (res.nerr < 0) return true;
+  uint8_t code[162];
+  SBFcoDecoder::encode_BCNV3(res.syms, code);
+  if (memcmp(code, res.syms, sizeof(code)) != 0) return false;
+  int nerr = 0;
+  for (int i = 0; i < 162; ++i) nerr += __builtin_popcount(unsigned((recv.syms[i] ^ res.syms[i]) & 0x3F));
+  return nerr == res.nerr;
+}
+}
+
+std::vector<SBFcoBenchResult> SBFcoRunBenchmark(const SBFcoBenchConfig& cfg) {
+  std::vector<SBFcoBenchResult> out;
+  if (cfg.pages <= 0) return out;
+  std::vector<SBFcoDecoder::Page> sent, recv;
+  makePages(cfg, sent, recv);
+
+  std::vector<SBFcoDecoder::Result> res(cfg.pages);
+  auto score = [&](const char* name, double secs) {
+    SBFcoBenchResult r;
+    r.decoder = name;
+    r.pages = cfg.pages;
+    r.frameErrors = 0;
+    double iters = 0.0;
+    for (int p = 0; p < cfg.pages; ++p) {
+      if (memcmp(res[p].syms, sent[p].syms, sizeof(sent[p].syms)) != 0) ++r.frameErrors;
+      iters += res[p].iterations;
+    }
+    r.frameErrorRate = double(r.frameErrors) / cfg.pages;
+    r.avgIterations = iters / cfg.pages;
+    r.pagesPerSec = secs > 0.0 ? cfg.pages / secs : 0.0;
+    out.push_back(r);
+  };
+  typedef std::chrono::steady_clock clk;
+  SBFcoDecoder::Config dec = cfg.decoder;
+  clk::time_point t0;
+  for (const BenchVariant& v : BENCH_VARIANTS) {
+    dec.engine = v.engine;
+    dec.schedule = v.schedule;
+    t0 = clk::now();
+    for (int p = 0; p < cfg.pages; ++p) SBFcoDecoder::decode_page(recv[p], res[p], dec);
+    score(v.name, std::chrono::duration<double>(clk::now() - t0).count());
+  }
+
+  t0 = clk::now();
+  SBFcoDecoder::decode_batch(recv.data(), res.data(), cfg.pages, cfg.decoder);
+  score("minsum-batch", std::chrono::duration<double>(clk::now() - t0).count());
+  return out;
+}
+
+int SBFcoCheckDecoders(const SBFcoBenchConfig& cfg, FILE* log) {
+  if (cfg.pages <= 0) return 0;
+  std::vector<SBFcoDecoder::Page> sent, recv;
+  makePages(cfg, sent, recv);
+  int violations = 0;
+  auto check = [&](const char* name, const std::vector<SBFcoDecoder::Result>& res) {
+    for (int p = 0; p < cfg.pages; ++p) {
+      bool ok = resultConsistent(recv[p], res[p]);
+      if (memcmp(recv[p].syms, sent[p].syms, sizeof(sent[p].syms)) == 0) {
+        ok = ok && res[p].nerr == 0 && memcmp(res[p].syms, sent[p].syms, sizeof(sent[p].syms)) == 0;
+      }
+      if (ok) continue;
+      ++violations;
+      if (log) fprintf(log, "%s: page %d inconsistent (nerr=%d)\n", name, p, res[p].nerr);
+    }
+  };
+  std::vector<SBFcoDecoder::Result> res(cfg.pages);
+  SBFcoDecoder::Config dec = cfg.decoder;
+  for (const BenchVariant& v : BENCH_VARIANTS) {
+    dec.engine = v.engine;
+    dec.schedule = v.schedule;
+    for (int p = 0; p < cfg.pages; ++p) SBFcoDecoder::decode_page(recv[p], res[p], dec);
+    check(v.name, res);
+  }
+  SBFcoDecoder::decode_batch(recv.data(), res.data(), cfg.pages, cfg.decoder);
+  check("minsum-batch", res);
+  return violations;
+}
+
+#ifdef SBFCO_BENCH_MAIN
+// Standalone driver: sbfcobench [pages] [symbolErrorRate] [bitErrorRate] [seed] [maxIter] [nmEms]
+// Exits non-zero when SBFcoCheckDecoders() finds an inconsistent result.
+int main(int argc, char** argv) {
+  SBFcoBenchConfig cfg;
+  if (argc > 1) cfg.pages = atoi(argv[1]);
+  if (argc > 2) cfg.symbolErrorRate = atof(argv[2]);
+  if (argc > 3) cfg.bitErrorRate = atof(argv[3]);
+  if (argc > 4) cfg.seed = unsigned(strtoul(argv[4], nullptr, 10));
+  if (argc > 5) cfg.decoder.maxIter = atoi(argv[5]);
+  if (argc > 6) cfg.decoder.nmEms = atoi(argv[6]);
+  printf("pages=%d symErr=%g bitErr=%g seed=%u maxIter=%d nmEms=%d batchKernel=%s\n", cfg.pages,
+         cfg.symbolErrorRate, cfg.bitErrorRate, cfg.seed, cfg.decoder.maxIter, cfg.decoder.nmEms,
+         SBFcoDecoder::batchKernelPathName());
+  printf("%-16s %8s %10s %9s %12s\n", "decoder", "frameErr", "FER", "avgIter", "pages/s");
+  std::vector<SBFcoBenchResult> results = SBFcoRunBenchmark(cfg);
+  for (size_t i = 0; i < results.size(); ++i) {
+    const SBFcoBenchResult& r = results[i];
+    printf("%-16s %8d %10.2e %9.2f %12.1f\n", r.decoder, r.frameErrors, r.frameErrorRate, r.avgIterations, r.pagesPerSec);
+  }
+  int violations = SBFcoCheckDecoders(cfg, stdout);
+  printf("check: %d inconsistent results\n", violations);
+  return violations == 0 ? 0 : 1;
+}
+#endif
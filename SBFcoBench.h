@@ -0,0 +1,37 @@
+#ifndef SBF_CO_BENCH_H
+#define SBF_CO_BENCH_H
+
+#include <cstdio>
+#include <vector>
+
+#include "SBFcoDecoder.h"
+
+// BER/throughput harness for the BCNV3 decoders: random B2b pages are
+// encoded with SBFcoDecoder::encode_BCNV3(), corrupted at the configured
+// rates and decoded by every decoder variant.
+struct SBFcoBenchConfig {
+  int pages = 1000;
+  double symbolErrorRate = 0.0;  // probability a GF(64) symbol is replaced
+  double bitErrorRate = 0.0;     // probability a single code bit is flipped
+  unsigned seed = 1;
+  SBFcoDecoder::Config decoder;  // limits applied to every variant; schedule is set per variant
+};
+
+struct SBFcoBenchResult {
+  const char* decoder;
+  int pages;
+  int frameErrors;       // pages not restored to the transmitted codeword
+  double frameErrorRate;
+  double avgIterations;
+  double pagesPerSec;
+};
+
+std::vector<SBFcoBenchResult> SBFcoRunBenchmark(const SBFcoBenchConfig& cfg);
+
+// Correctness check shared by all engines on the same pages: every page a
+// decoder reports as decoded must be a BCNV3 codeword at the reported bit
+// distance from its input, and error-free pages must come back unchanged.
+// Returns the number of violations; each one is logged to log if given.
+int SBFcoCheckDecoders(const SBFcoBenchConfig& cfg, FILE* log = nullptr);
+
+#endif
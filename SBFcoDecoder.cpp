@@ -1,10 +1,24 @@
 #include "SBFcoDecoder.h"
+#include "SBFcoGF64.h"
 
 #include <cstring>
 #include <cctype>
 #include <cmath>
 #include <algorithm>
+#include <limits>
+#include <cstdlib>
 
+// The batch decoder body is force-inlined into per-ISA wrappers (see bcnv3_kernels()).
+#if defined(__GNUC__)
+#define SBFCO_KERNEL_INLINE __attribute__((always_inline))
+#else
+#define SBFCO_KERNEL_INLINE
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SBFCO_X86_DISPATCH 1
+#endif
+
+#ifndef SBFCO_NO_QT
 // Helpers similar to Python read_hex, hex_str, and sdr_ldpc.decode_LDPC
 
 static inline uint8_t hexNibble(QChar c) {
@@ -13,7 +27,87 @@ static inline uint8_t hexNibble(QChar c) {
   if (c >= 'A' && c <= 'F') return uint8_t(c.unicode() - 'A' + 10);
   return 0;
 }
+#endif
+
+// BCNV3 (162,81) code over GF(2^6), check matrix per spec [6] 6.2.2
+static const int BCNV3_M = 81;
+static const int BCNV3_N = 162;
+static const int BCNV3_DC = 4;
+static const int BCNV3_DV = 2;
+static const int H_idx_raw[BCNV3_M][BCNV3_DC] = {
+  {19,67,109,130},{27,71,85,161},{31,78,96,122},{2,44,83,125},
+  {26,71,104,132},{30,39,93,154},{4,46,85,127},{21,62,111,127},
+  {13,42,101,146},{18,66,108,129},{27,72,100,153},{29,70,84,160},
+  {23,61,113,126},{8,50,89,131},{34,74,111,157},{12,44,100,145},
+  {22,60,112,128},{0,49,115,151},{6,47,106,144},{33,53,82,140},
+  {3,45,84,126},{38,80,109,147},{9,60,96,141},{1,43,82,124},
+  {20,77,88,158},{37,54,122,159},{3,65,104,149},{5,47,86,128},
+  {0,42,81,123},{32,79,97,120},{35,72,112,158},{15,57,93,138},
+  {22,75,107,143},{24,69,102,133},{1,50,116,152},{24,57,119,135},
+  {17,59,95,140},{7,45,107,145},{34,51,83,138},{14,43,99,144},
+  {21,77,106,142},{16,58,94,139},{20,68,110,131},{2,48,114,150},
+  {10,52,91,133},{25,70,103,134},{32,41,95,153},{14,56,91,137},
+  {33,73,113,156},{28,73,101,154},{4,63,102,147},{6,48,87,129},
+  {8,46,105,146},{30,80,98,121},{41,68,119,150},{35,52,81,139},
+  {16,63,114,124},{13,55,90,136},{31,40,94,155},{10,61,97,142},
+  {36,56,121,161},{29,74,99,155},{5,64,103,148},{18,75,89,156},
+  {36,78,110,148},{19,76,87,157},{15,65,116,123},{11,53,92,134},
+  {25,58,117,136},{39,66,117,151},{11,62,98,143},{9,51,90,132},
+  {38,55,120,160},{7,49,88,130},{17,64,115,125},
+  {28,69,86,159},{23,76,105,141},{12,54,92,135},
+  {40,67,118,152},{37,79,108,149},{26,59,118,137}
+};
+static const uint8_t H_ele_raw[BCNV3_M][BCNV3_DC] = {
+  {46,45,44,15},{15,24,50,37},{24,50,37,15},{15,32,18,61},
+  {58,56,60,62},{37,53,61,29},{46,58,18,6},{36,19,3,57},
+  {54,7,38,23},{51,59,63,47},{9,3,43,29},{56,8,46,13},
+  {26,22,14,2},{63,26,41,12},{17,32,58,37},{38,23,55,22},
+  {35,1,31,44},{44,51,35,13},{30,1,44,7},{27,5,2,62},
+  {16,63,20,9},{27,56,8,43},{1,44,30,24},{5,26,27,37},
+  {42,47,37,32},{38,12,25,51},{43,34,48,57},{39,9,30,48},
+  {63,13,54,10},{2,46,56,35},{47,20,33,26},{62,54,56,60},
+  {1,21,25,7},{43,58,19,49},{28,4,52,44},{46,44,14,15},
+  {41,48,2,27},{49,21,7,35},{40,21,44,17},{24,23,45,11},
+  {46,25,22,48},{13,29,53,61},{52,17,24,61},{29,41,10,16},
+  {60,24,4,50},{32,49,58,19},{43,34,48,57},{29,7,10,16},
+  {25,11,7,1},{32,49,58,19},{42,14,24,33},{39,56,30,48},
+  {13,27,56,8},{53,40,61,18},{8,43,27,56},{18,40,32,61},
+  {60,48,2,27},{50,54,60,62},{58,19,32,49},{9,3,63,43},
+  {53,35,16,13},{23,25,30,16},{18,6,61,21},{15,1,42,45},
+  {20,16,63,9},{27,37,5,26},{29,7,10,16},{11,60,6,49},
+  {43,47,18,20},{42,14,24,33},{43,22,41,20},{22,15,12,33},
+  {9,41,57,58},{5,31,51,30},{9,3,63,43},
+  {37,53,61,29},{6,45,56,19},{33,45,36,34},
+  {19,24,42,14},{1,45,15,6},{8,43,27,56}
+};
+
+// Symbol flips the hard-decision fast path may take before a page goes to
+// message passing.
+static const int BCNV3_FAST_FLIPS = 2;
+static int bcnv3_hard_fix(uint8_t* code, int maxFlips);
+static int bcnv3_bit_errors(const uint8_t* a, const uint8_t* b);
+
+// H as the edge lists decode_LDPC_BCNV3_bits() takes, built once, on the
+// first page that needs message passing.
+namespace {
+struct BCNV3Tables {
+  std::vector<std::vector<int>> idx;
+  std::vector<std::vector<uint8_t>> ele;
+  BCNV3Tables() : idx(BCNV3_M, std::vector<int>(BCNV3_DC)), ele(BCNV3_M, std::vector<uint8_t>(BCNV3_DC)) {
+    for (int i = 0; i < BCNV3_M; ++i) {
+      for (int j = 0; j < BCNV3_DC; ++j) { idx[i][j] = H_idx_raw[i][j]; ele[i][j] = H_ele_raw[i][j]; }
+    }
+  }
+};
+}
 
+static const BCNV3Tables& bcnv3_tables() {
+  static const BCNV3Tables tables;
+  return tables;
+}
+
+
+#ifndef SBFCO_NO_QT
 std::vector<uint8_t> SBFcoDecoder::hexToBytesSanitized(const QString& hex) {
   QString s;
   s.reserve(hex.size());
@@ -47,6 +141,7 @@ QString SBFcoDecoder::bytesToHex(const std::vector<uint8_t>& bytes) {
   }
   return out;
 }
+#endif
 
 std::vector<uint8_t> SBFcoDecoder::bytesToBitsBE(const std::vector<uint8_t>& bytes) {
   std::vector<uint8_t> bits;
@@ -71,13 +166,14 @@ std::vector<uint8_t> SBFcoDecoder::bitsToBytesBE(const std::vector<uint8_t>& bit
   return out;
 }
 
+#ifndef SBFCO_NO_QT
 QString SBFcoDecoder::bitsToHex(const std::vector<uint8_t>& bits) {
   return bytesToHex(bitsToBytesBE(bits));
 }
 
 
 
-QByteArray SBFcoDecoder::decode_LDPC_navbitsRaw(const QByteArray& navBits) {
+QByteArray SBFcoDecoder::decode_LDPC_navbitsRaw(const QByteArray& navBits, DecodeInfo* info, const Config& config) {
   // 输入即 16 进制文本（例如 248 个十六进制字符）。
   // 1) 转为 UTF-8 字符串
   QString navHex = QString::fromUtf8(navBits);
@@ -100,65 +196,8 @@ QByteArray SBFcoDecoder::decode_LDPC_navbitsRaw(const QByteArray& navBits) {
     // fprintf(stderr, "[B2b] bits after drop12 (len=%zu): %s\n", bits.size(), bitsStr.toUtf8().constData());
   }
   
-  // 5) 占位 LDPC 解码
-  // 构建 BCNV3 矩阵并解码（162,81）
-  static const int N_GF = 6;
-  static const int M = 81;
-  static const int N = 162;
-  // H_BCNV3_idx/H_BCNV3_ele 按规范 [6] 6.2.2
-  static const int H_idx_raw[81][4] = {
-    {19,67,109,130},{27,71,85,161},{31,78,96,122},{2,44,83,125},
-    {26,71,104,132},{30,39,93,154},{4,46,85,127},{21,62,111,127},
-    {13,42,101,146},{18,66,108,129},{27,72,100,153},{29,70,84,160},
-    {23,61,113,126},{8,50,89,131},{34,74,111,157},{12,44,100,145},
-    {22,60,112,128},{0,49,115,151},{6,47,106,144},{33,53,82,140},
-    {3,45,84,126},{38,80,109,147},{9,60,96,141},{1,43,82,124},
-    {20,77,88,158},{37,54,122,159},{3,65,104,149},{5,47,86,128},
-    {0,42,81,123},{32,79,97,120},{35,72,112,158},{15,57,93,138},
-    {22,75,107,143},{24,69,102,133},{1,50,116,152},{24,57,119,135},
-    {17,59,95,140},{7,45,107,145},{34,51,83,138},{14,43,99,144},
-    {21,77,106,142},{16,58,94,139},{20,68,110,131},{2,48,114,150},
-    {10,52,91,133},{25,70,103,134},{32,41,95,153},{14,56,91,137},
-    {33,73,113,156},{28,73,101,154},{4,63,102,147},{6,48,87,129},
-    {8,46,105,146},{30,80,98,121},{41,68,119,150},{35,52,81,139},
-    {16,63,114,124},{13,55,90,136},{31,40,94,155},{10,61,97,142},
-    {36,56,121,161},{29,74,99,155},{5,64,103,148},{18,75,89,156},
-    {36,78,110,148},{19,76,87,157},{15,65,116,123},{11,53,92,134},
-    {25,58,117,136},{39,66,117,151},{11,62,98,143},{9,51,90,132},
-    {38,55,120,160},{7,49,88,130},{17,64,115,125},
-    {28,69,86,159},{23,76,105,141},{12,54,92,135},
-    {40,67,118,152},{37,79,108,149},{26,59,118,137}
-  };
-  static const uint8_t H_ele_raw[81][4] = {
-    {46,45,44,15},{15,24,50,37},{24,50,37,15},{15,32,18,61},
-    {58,56,60,62},{37,53,61,29},{46,58,18,6},{36,19,3,57},
-    {54,7,38,23},{51,59,63,47},{9,3,43,29},{56,8,46,13},
-    {26,22,14,2},{63,26,41,12},{17,32,58,37},{38,23,55,22},
-    {35,1,31,44},{44,51,35,13},{30,1,44,7},{27,5,2,62},
-    {16,63,20,9},{27,56,8,43},{1,44,30,24},{5,26,27,37},
-    {42,47,37,32},{38,12,25,51},{43,34,48,57},{39,9,30,48},
-    {63,13,54,10},{2,46,56,35},{47,20,33,26},{62,54,56,60},
-    {1,21,25,7},{43,58,19,49},{28,4,52,44},{46,44,14,15},
-    {41,48,2,27},{49,21,7,35},{40,21,44,17},{24,23,45,11},
-    {46,25,22,48},{13,29,53,61},{52,17,24,61},{29,41,10,16},
-    {60,24,4,50},{32,49,58,19},{43,34,48,57},{29,7,10,16},
-    {25,11,7,1},{32,49,58,19},{42,14,24,33},{39,56,30,48},
-    {13,27,56,8},{53,40,61,18},{8,43,27,56},{18,40,32,61},
-    {60,48,2,27},{50,54,60,62},{58,19,32,49},{9,3,63,43},
-    {53,35,16,13},{23,25,30,16},{18,6,61,21},{15,1,42,45},
-    {20,16,63,9},{27,37,5,26},{29,7,10,16},{11,60,6,49},
-    {43,47,18,20},{42,14,24,33},{43,22,41,20},{22,15,12,33},
-    {9,41,57,58},{5,31,51,30},{9,3,63,43},
-    {37,53,61,29},{6,45,56,19},{33,45,36,34},
-    {19,24,42,14},{1,45,15,6},{8,43,27,56}
-  };
-  std::vector<std::vector<int>> H_idx(M, std::vector<int>(4));
-  std::vector<std::vector<uint8_t>> H_ele(M, std::vector<uint8_t>(4));
-  for (int i = 0; i < M; ++i) {
-    for (int j = 0; j < 4; ++j) { H_idx[i][j] = H_idx_raw[i][j]; H_ele[i][j] = H_ele_raw[i][j]; }
-  }
-  auto decPair = decode_LDPC_BCNV3_bits(H_idx, H_ele, M, N, bits);
-  std::vector<uint8_t>& decBits = decPair.first;
+  // 5) LDPC 解码（BCNV3 (162,81)）
+  std::vector<uint8_t> decBits = decode_page_bits(bits, nullptr, info, config);
   // 6) 将比特转回十六进制，并在奇数长度时补齐到偶数后 unhexlify
   QString hexTxt = hex_str_from_bits(decBits);
   if (hexTxt.size() % 2 == 1) {
@@ -168,6 +207,139 @@ QByteArray SBFcoDecoder::decode_LDPC_navbitsRaw(const QByteArray& navBits) {
   return QByteArray(reinterpret_cast<const char*>(outBytes.data()), int(outBytes.size()));
 }
 
+QByteArray SBFcoDecoder::decode_LDPC_navWords(const uint32_t* words, DecodeInfo* info, const Config& config) {
+  // Clean and lightly damaged pages settle on stack buffers unpacked from the
+  // words; only the returned array is allocated. Other pages are voted as a
+  // single copy.
+  const int SKIP_BITS = 12;
+  uint8_t recv[BCNV3_N];
+  uint8_t code[BCNV3_N];
+  for (int i = 0; i < BCNV3_N; ++i) {
+    uint8_t v = 0;
+    for (int b = 0; b < 6; ++b) {
+      const int pos = SKIP_BITS + i * 6 + b;
+      v = uint8_t((v << 1) | ((words[pos / 32] >> (31 - pos % 32)) & 1));
+    }
+    recv[i] = code[i] = v;
+  }
+  if (bcnv3_hard_fix(code, BCNV3_FAST_FLIPS) != 0) {
+    return decode_LDPC_navWordsVoted(std::vector<const uint32_t*>(1, words), info, config);
+  }
+  QByteArray out((BCNV3_N * 6 + 7) / 8, '\0');
+  char* outBytes = out.data();
+  for (int i = 0; i < BCNV3_N * 6; ++i) {
+    if ((code[i / 6] >> (5 - i % 6)) & 1) outBytes[i / 8] = char(outBytes[i / 8] | (0x80 >> (i % 8)));
+  }
+  if (info) {
+    info->nerr = bcnv3_bit_errors(recv, code);
+    info->iterations = 0;
+    info->symbolsCorrected = 0;
+    for (int i = 0; i < BCNV3_N; ++i) if (recv[i] != code[i]) ++info->symbolsCorrected;
+    info->copies = 1;
+  }
+  return out;
+}
+
+QByteArray SBFcoDecoder::decode_LDPC_navWordsVoted(const std::vector<const uint32_t*>& copies, DecodeInfo* info,
+                                                   const Config& config, const std::vector<double>* copyErrProb) {
+  // Same bit window as decode_LDPC_navbitsRaw(): skip 12 bits, take 972.
+  const int SKIP_BITS = 12;
+  const int NBITS = BCNV3_N * 6;
+  const int ncopies = int(copies.size());
+  if (ncopies == 0) return QByteArray();
+  std::vector<uint8_t> bits(NBITS);
+  std::vector<float> weight(NBITS);
+  if (copyErrProb && int(copyErrProb->size()) == ncopies) {
+    // Weighted vote: copy c adds +-log((1-p_c)/p_c); the weight is the sum
+    // in units of the config's single-copy LLR, which decode_page_bits()
+    // multiplies back in.
+    const double p0 = (config.errProb > 0.0 && config.errProb < 0.5) ? config.errProb : 1e-5;
+    const double llr0 = -std::log(p0);
+    std::vector<double> llr(ncopies);
+    for (int c = 0; c < ncopies; ++c) {
+      double p = (*copyErrProb)[c];
+      llr[c] = (p > 0.0 && p < 0.5) ? std::log((1.0 - p) / p) : llr0;
+    }
+    for (int i = 0; i < NBITS; ++i) {
+      const int pos = SKIP_BITS + i;
+      double sum = 0.0;
+      for (int c = 0; c < ncopies; ++c) sum += ((copies[c][pos / 32] >> (31 - pos % 32)) & 1) ? llr[c] : -llr[c];
+      bits[i] = uint8_t(sum > 0.0);
+      weight[i] = float(std::fabs(sum) / llr0);
+    }
+  } else {
+    for (int i = 0; i < NBITS; ++i) {
+      const int pos = SKIP_BITS + i;
+      int ones = 0;
+      for (const uint32_t* w : copies) ones += int((w[pos / 32] >> (31 - pos % 32)) & 1);
+      // Vote margin: n copies agreeing give n times the single-copy LLR, a tie
+      // leaves the bit as an erasure for the decoder to fill in.
+      const int margin = 2 * ones - ncopies;
+      bits[i] = uint8_t(margin > 0);
+      weight[i] = float(margin < 0 ? -margin : margin);
+    }
+  }
+  std::vector<uint8_t> decBits = decode_page_bits(bits, &weight, info, config);
+  if (info) info->copies = ncopies;
+  std::vector<uint8_t> outBytes = bitsToBytesBE(decBits);
+  return QByteArray(reinterpret_cast<const char*>(outBytes.data()), int(outBytes.size()));
+}
+#endif
+
+double SBFcoDecoder::errProbFromCN0(double cn0DbHz) {
+  // Es/N0 = C/N0 - 10*log10(1000 sps); BPSK: p = Q(sqrt(2 Es/N0)) = erfc(sqrt(Es/N0)) / 2
+  const double esn0 = std::pow(10.0, (cn0DbHz - 30.0) / 10.0);
+  const double p = 0.5 * std::erfc(std::sqrt(esn0));
+  return std::min(std::max(p, 1e-9), 0.25);
+}
+
+std::vector<uint8_t> SBFcoDecoder::decode_page_bits(const std::vector<uint8_t>& bits,
+                                                    const std::vector<float>* bitWeight,
+                                                    DecodeInfo* info,
+                                                    const Config& config) {
+  // Syndrome check and symbol flipping on the hard decision first; only a
+  // page that fails them goes through message passing (162,81)
+  std::vector<uint8_t> decBits;
+  int nerr = 0;
+  int iterations = 0;
+  uint8_t recv[BCNV3_N];
+  uint8_t code[BCNV3_N];
+  bool settled = false;
+  if (int(bits.size()) == BCNV3_N * 6) {
+    for (int i = 0; i < BCNV3_N; ++i) {
+      uint8_t v = 0;
+      for (int b = 0; b < 6; ++b) v = uint8_t((v << 1) | (bits[i * 6 + b] & 1));
+      recv[i] = code[i] = v;
+    }
+    settled = bcnv3_hard_fix(code, BCNV3_FAST_FLIPS) == 0;
+  }
+  if (settled) {
+    decBits.resize(bits.size());
+    for (int i = 0; i < BCNV3_N; ++i) {
+      for (int b = 0; b < 6; ++b) decBits[i * 6 + b] = uint8_t((code[i] >> (5 - b)) & 1);
+    }
+    nerr = bcnv3_bit_errors(recv, code);
+  } else {
+    const BCNV3Tables& H = bcnv3_tables();
+    auto decPair = decode_LDPC_BCNV3_bits(H.idx, H.ele, BCNV3_M, BCNV3_N, bits, &iterations, config, bitWeight);
+    decBits.swap(decPair.first);
+    nerr = decPair.second;
+  }
+  if (info) {
+    info->nerr = nerr;
+    info->iterations = iterations;
+    info->symbolsCorrected = 0;
+    info->copies = 1;
+    for (size_t i = 0; i + 6 <= decBits.size() && i + 6 <= bits.size(); i += 6) {
+      for (size_t j = i; j < i + 6; ++j) {
+        if ((decBits[j] ^ bits[j]) & 1) { ++info->symbolsCorrected; break; }
+      }
+    }
+  }
+  return decBits;
+}
+
+#ifndef SBFCO_NO_QT
 // Python-equivalent helpers for nibble-wise hex<->bits
 std::vector<uint8_t> SBFcoDecoder::read_hex_bits(const QString& hex) {
   // N = len(str0) * 4; data[i] = (int(str0[i // 4], 16) >> (3 - i % 4)) & 1
@@ -210,43 +382,53 @@ QString SBFcoDecoder::hex_str_from_bits(const std::vector<uint8_t>& bits) {
   }
   return out;
 }
+#endif
 
-std::pair<std::vector<uint8_t>, int> SBFcoDecoder::decode_LDPC_BCNV3_bits(const std::vector<std::vector<int>>& H_idx,
-                                                                          const std::vector<std::vector<uint8_t>>& H_ele,
-                                                                          int m,
-                                                                          int n,
-                                                                          const std::vector<uint8_t>& syms) {
+// Body of decode_LDPC_BCNV3_bits(). Callers have run bcnv3_hard_fix()
+// already; a page reaching here needs message passing. It is built for the
+// baseline ISA only: its time goes to sorting and vector traffic, which an
+// AVX2 build did not speed up.
+static std::pair<std::vector<uint8_t>, int>
+bcnv3_ems_decode(const std::vector<std::vector<int>>& H_idx,
+                 const std::vector<std::vector<uint8_t>>& H_ele,
+                 int m,
+                 int n,
+                 const std::vector<uint8_t>& syms,
+                 int* iterations,
+                 const SBFcoDecoder::Config& config,
+                 const std::vector<float>* bitWeight) {
+  (void)n;
   const int N_GF = 6;
   const int Q_GF = 64;
-  const int MAX_ITER = 15;
-  const int NM_EMS = 4;
-  const double ERR_PROB = 1e-5;
-  static const uint8_t GF_VEC[63] = {1,2,4,8,16,32,3,6,12,24,48,35,5,10,20,40,19,38,15,30,60,59,53,41,17,34,7,14,28,56,51,37,9,18,36,11,22,44,27,54,47,29,58,55,45,25,50,39,13,26,52,43,21,42,23,46,31,62,63,61,57,49,33};
-  static const uint8_t GF_POW[64] = {0,0,1,6,2,12,7,26,3,32,13,35,8,48,27,18,4,24,33,16,14,52,36,54,9,45,49,38,28,41,19,56,5,62,25,11,34,31,17,47,15,23,53,51,37,44,55,40,10,61,46,30,50,22,39,43,29,60,42,21,20,59,57,58};
-  static std::vector<std::vector<uint8_t>> GF_MUL;
-  if (GF_MUL.empty()) {
-    GF_MUL.assign(Q_GF, std::vector<uint8_t>(Q_GF, 0));
-    for (int i = 1; i < Q_GF; ++i) {
-      for (int j = 1; j < Q_GF; ++j) {
-        GF_MUL[i][j] = GF_VEC[(GF_POW[i] + GF_POW[j]) % (Q_GF - 1)];
-      }
-    }
-  }
+  const int MAX_ITER = std::max(config.maxIter, 1);
+  const int NM_EMS = std::min(std::max(config.nmEms, 1), Q_GF);
+  const double ERR_PROB = (config.errProb > 0.0 && config.errProb < 0.5) ? config.errProb : 1e-5;
+  const SBFcoDecoder::Schedule schedule = config.schedule;
+  // Truncated EMS messages are over-confident; both schedules oscillate on
+  // them unless C2V is scaled down. Min-max messages are not truncated and
+  // are used as they are.
+  const float C2V_SCALE = config.engine == SBFcoDecoder::ENGINE_MIN_MAX ? 1.0f : 0.625f;
   int nvars = int(syms.size()) / N_GF;
   if (nvars <= 0) return {std::vector<uint8_t>(), 0};
+  auto gf2bin = [&](const uint8_t* c, size_t nc) {
+    std::vector<uint8_t> syms(nc * N_GF, 0);
+    for (size_t i = 0; i < nc; ++i) {
+      for (int j = 0; j < N_GF; ++j) syms[i * N_GF + j] = uint8_t((c[i] >> (N_GF - 1 - j)) & 1);
+    }
+    return syms;
+  };
+  auto bit_errors = [&](const std::vector<uint8_t>& syms_dec) {
+    int nerr = 0;
+    size_t Lmin = std::min(syms_dec.size(), syms.size());
+    for (size_t i = 0; i < Lmin; ++i) if ((syms_dec[i] ^ syms[i]) & 1) ++nerr;
+    return nerr;
+  };
   std::vector<uint8_t> code(nvars, 0);
   for (int i = 0; i < nvars; ++i) {
     uint8_t v = 0;
     for (int j = 0; j < N_GF; ++j) v = uint8_t((v << 1) | (syms[i * N_GF + j] & 1));
     code[i] = v;
   }
-  auto gf2bin = [&](const std::vector<uint8_t>& c) {
-    std::vector<uint8_t> syms(c.size() * N_GF, 0);
-    for (size_t i = 0; i < c.size(); ++i) {
-      for (int j = 0; j < N_GF; ++j) syms[i * N_GF + j] = uint8_t((c[i] >> (N_GF - 1 - j)) & 1);
-    }
-    return syms;
-  };
   auto bitcnt6 = [&](uint8_t x) { return int(__builtin_popcount(uint32_t(x & 0x3F))); };
   std::vector<int> ie;
   std::vector<int> je;
@@ -260,6 +442,17 @@ std::pair<std::vector<uint8_t>, int> SBFcoDecoder::decode_LDPC_BCNV3_bits(const
       L[i][j] = float(-std::log(ERR_PROB) * bitcnt6(uint8_t(code[i] ^ j)));
     }
   }
+  if (bitWeight && int(bitWeight->size()) >= nvars * N_GF) {
+    for (int i = 0; i < nvars; ++i) {
+      for (int j = 0; j < Q_GF; ++j) {
+        double w = 0.0;
+        for (int b = 0; b < N_GF; ++b) {
+          if (((code[i] ^ j) >> (N_GF - 1 - b)) & 1) w += (*bitWeight)[i * N_GF + b];
+        }
+        L[i][j] = float(-std::log(ERR_PROB) * w);
+      }
+    }
+  }
   for (int i = 0; i < (int)H_idx.size(); ++i) {
     for (int j = 0; j < (int)H_idx[i].size(); ++j) {
       ie.push_back(i);
@@ -270,13 +463,548 @@ std::pair<std::vector<uint8_t>, int> SBFcoDecoder::decode_LDPC_BCNV3_bits(const
   ne = int(ie.size());
   V2C.assign(ne, std::vector<float>(Q_GF, 0.0f));
   C2V.assign(ne, std::vector<float>(Q_GF, 0.0f));
+  for (int i = 0; i < ne; ++i) {
+    for (int x = 0; x < Q_GF; ++x) V2C[i][gf64::mul(he[i], x)] = L[je[i]][x];
+  }
+  // Both schedules keep the syndrome up to date from hard-decision changes
+  // instead of re-checking every row after each iteration.
+  std::vector<std::vector<int>> rowEdges(m), colEdges(nvars);
+  for (int i = 0; i < ne; ++i) {
+    rowEdges[ie[i]].push_back(i);
+    if (je[i] < nvars) colEdges[je[i]].push_back(i);
+  }
+  std::vector<uint8_t> synd(m, 0);
+  for (int i = 0; i < ne; ++i) synd[ie[i]] ^= gf64::mul(he[i], code[je[i]]);
+  int nbad = 0;
+  for (int i = 0; i < m; ++i) if (synd[i] != 0) ++nbad;
+  auto set_hard = [&](int j, uint8_t v) {
+    uint8_t d = uint8_t(code[j] ^ v);
+    code[j] = v;
+    for (int ce : colEdges[j]) {
+      bool was = synd[ie[ce]] != 0;
+      synd[ie[ce]] ^= gf64::mul(he[ce], d);
+      nbad += int(synd[ie[ce]] != 0) - int(was);
+    }
+  };
+  auto ext_min_sum = [&](const std::vector<float>& A, const std::vector<float>& B) {
+    if (A.empty()) return B;
+    std::vector<int> idxA(Q_GF), idxB(Q_GF);
+    for (int i = 0; i < Q_GF; ++i) { idxA[i] = i; idxB[i] = i; }
+    std::sort(idxA.begin(), idxA.end(), [&](int a, int b){ return A[a] < A[b]; });
+    std::sort(idxB.begin(), idxB.end(), [&](int a, int b){ return B[a] < B[b]; });
+    float maxL = A[idxA[NM_EMS - 1]] + B[idxB[NM_EMS - 1]];
+    std::vector<float> Ls(Q_GF, maxL);
+    for (int ia = 0; ia < NM_EMS; ++ia) {
+      int iA = idxA[ia];
+      for (int ib = 0; ib < NM_EMS; ++ib) {
+        int iB = idxB[ib];
+        int idx = iA ^ iB;
+        float v = A[iA] + B[iB];
+        if (v < Ls[idx]) Ls[idx] = v;
+      }
+    }
+    return Ls;
+  };
+  // Min-max keeps every pair: the cost of a GF(64) sum is the larger of its
+  // two inputs, so no truncation is needed and messages stay bounded.
+  auto min_max = [&](const std::vector<float>& A, const std::vector<float>& B) {
+    if (A.empty()) return B;
+    std::vector<float> Ls(Q_GF, std::numeric_limits<float>::max());
+    for (int iA = 0; iA < Q_GF; ++iA) {
+      for (int iB = 0; iB < Q_GF; ++iB) {
+        float v = std::max(A[iA], B[iB]);
+        if (v < Ls[iA ^ iB]) Ls[iA ^ iB] = v;
+      }
+    }
+    return Ls;
+  };
+  auto check_combine = [&](const std::vector<float>& A, const std::vector<float>& B) {
+    return config.engine == SBFcoDecoder::ENGINE_MIN_MAX ? min_max(A, B) : ext_min_sum(A, B);
+  };
+  if (schedule == SBFcoDecoder::SCHEDULE_LAYERED) {
+    // Row-serial schedule: each check row reads the current posteriors,
+    // refreshes its C2V messages and writes the posteriors straight back, so
+    // later rows in the same sweep already see the update.
+    std::vector<std::vector<float>> APP = L;
+    std::vector<std::vector<float>> Q;
+    int it = 0;
+    for (; it < MAX_ITER && nbad > 0; ++it) {
+      for (int r = 0; r < m && nbad > 0; ++r) {
+        const std::vector<int>& row = rowEdges[r];
+        Q.assign(row.size(), std::vector<float>(Q_GF, 0.0f));
+        for (size_t k = 0; k < row.size(); ++k) {
+          int e = row[k];
+          std::vector<float>& q = Q[k];
+          for (int x = 0; x < Q_GF; ++x) q[x] = APP[je[e]][x] - C2V[e][x];
+          float mn = *std::min_element(q.begin(), q.end());
+          for (float& v : q) v -= mn;
+          for (int x = 0; x < Q_GF; ++x) V2C[e][gf64::mul(he[e], x)] = q[x];
+        }
+        for (size_t k = 0; k < row.size(); ++k) {
+          int e = row[k];
+          std::vector<float> Ls;
+          for (size_t kk = 0; kk < row.size(); ++kk) if (kk != k) Ls = check_combine(Ls, V2C[row[kk]]);
+          float mn = *std::min_element(Ls.begin(), Ls.end());
+          for (float& v : Ls) v -= mn;
+          for (int x = 0; x < Q_GF; ++x) C2V[e][x] = C2V_SCALE * Ls[gf64::mul(he[e], x)];
+        }
+        for (size_t k = 0; k < row.size(); ++k) {
+          int e = row[k];
+          int j = je[e];
+          std::vector<float>& app = APP[j];
+          int argmin = 0;
+          for (int x = 0; x < Q_GF; ++x) {
+            app[x] = Q[k][x] + C2V[e][x];
+            if (app[x] < app[argmin]) argmin = x;
+          }
+          if (argmin != code[j]) set_hard(j, uint8_t(argmin));
+        }
+      }
+    }
+    if (iterations) *iterations = it;
+    std::vector<uint8_t> syms_dec = gf2bin(code.data(), code.size());
+    return {syms_dec, nbad == 0 ? bit_errors(syms_dec) : -1};
+  }
+  // Flooding schedule: checks are refreshed from the previous V2C messages,
+  // then variables from the new C2V messages; the loop stops as soon as the
+  // syndrome clears. The first sweep covers the whole graph. After it a
+  // satisfied check is frozen while the argmins of its incoming V2C messages
+  // and the hard decisions of its variables hold, so only unsatisfied checks
+  // and their surroundings are refreshed, and a variable is recomputed only
+  // when one of its incoming C2V messages changed. Min-max keeps the full
+  // sweep: its unscaled messages lose more frames to frozen checks than the
+  // sweep costs.
+  const bool freeze = config.engine != SBFcoDecoder::ENGINE_MIN_MAX;
+  std::vector<char> rowDirty(m, 1), varDirty(nvars, 0);
+  std::vector<int> v2cArg(ne, -1);
+  int it = 0;
+  for (; it < MAX_ITER && nbad > 0; ++it) {
+    std::fill(varDirty.begin(), varDirty.end(), 0);
+    for (int r = 0; r < m; ++r) {
+      if (freeze && !rowDirty[r] && synd[r] == 0) continue;
+      const std::vector<int>& row = rowEdges[r];
+      for (size_t k = 0; k < row.size(); ++k) {
+        int e = row[k];
+        std::vector<float> Ls;
+        for (size_t kk = 0; kk < row.size(); ++kk) if (kk != k) Ls = check_combine(Ls, V2C[row[kk]]);
+        float mn = *std::min_element(Ls.begin(), Ls.end());
+        for (float& v : Ls) v -= mn;
+        bool changed = false;
+        for (int x = 0; x < Q_GF; ++x) {
+          float c = C2V_SCALE * Ls[gf64::mul(he[e], x)];
+          if (c != C2V[e][x]) { C2V[e][x] = c; changed = true; }
+        }
+        if (changed) varDirty[je[e]] = 1;
+      }
+    }
+    std::fill(rowDirty.begin(), rowDirty.end(), 0);
+    for (int j = 0; j < nvars; ++j) {
+      if (freeze && !varDirty[j]) continue;
+      const std::vector<int>& col = colEdges[j];
+      for (size_t k = 0; k < col.size(); ++k) {
+        int e = col[k];
+        std::vector<float> Ls = L[j];
+        for (size_t kk = 0; kk < col.size(); ++kk) if (kk != k) for (int x = 0; x < Q_GF; ++x) Ls[x] += C2V[col[kk]][x];
+        float mn = *std::min_element(Ls.begin(), Ls.end());
+        for (float& v : Ls) v -= mn;
+        for (int x = 0; x < Q_GF; ++x) V2C[e][gf64::mul(he[e], x)] = Ls[x];
+        int am = int(std::min_element(Ls.begin(), Ls.end()) - Ls.begin());
+        if (am != v2cArg[e]) { v2cArg[e] = am; rowDirty[ie[e]] = 1; }
+      }
+      std::vector<float> Li = L[j];
+      for (int e : col) for (int x = 0; x < Q_GF; ++x) Li[x] += C2V[e][x];
+      float mn = *std::min_element(Li.begin(), Li.end());
+      for (float& v : Li) v -= mn;
+      int argmin = 0;
+      for (int x = 1; x < Q_GF; ++x) if (Li[x] < Li[argmin]) argmin = x;
+      if (argmin != code[j]) {
+        set_hard(j, uint8_t(argmin));
+        for (int e : col) rowDirty[ie[e]] = 1;
+      }
+    }
+  }
+  if (iterations) *iterations = it;
+  std::vector<uint8_t> syms_dec = gf2bin(code.data(), code.size());
+  return {syms_dec, nbad == 0 ? bit_errors(syms_dec) : -1};
+}
+
+
+// Hard-decision syndrome check and single-symbol flipping on one codeword:
+// the zero-iteration exit of every decode path, run on the raw tables before
+// any message-passing state exists.
+static int bcnv3_hard_fix(uint8_t* code, int maxFlips) {
+  uint8_t synd[BCNV3_M];
+  int nbad = 0;
+  for (int r = 0; r < BCNV3_M; ++r) {
+    uint8_t s = 0;
+    for (int k = 0; k < BCNV3_DC; ++k) s ^= gf64::mul(H_ele_raw[r][k], code[H_idx_raw[r][k]]);
+    synd[r] = s;
+    if (s != 0) ++nbad;
+  }
+  for (int flip = 0; flip < maxFlips && nbad > 0; ++flip) {
+    int fv = -1;
+    uint8_t fe = 0;
+    for (int r = 0; r < BCNV3_M && fv < 0; ++r) {
+      if (synd[r] == 0) continue;
+      for (int k = 0; k < BCNV3_DC && fv < 0; ++k) {
+        int j = H_idx_raw[r][k];
+        uint8_t e = gf64::div(synd[r], H_ele_raw[r][k]);
+        int deg = 0;
+        bool clears = true;
+        for (int i = 0; i < BCNV3_M && clears; ++i) {
+          for (int kk = 0; kk < BCNV3_DC; ++kk) {
+            if (H_idx_raw[i][kk] != j) continue;
+            ++deg;
+            if (synd[i] != gf64::mul(H_ele_raw[i][kk], e)) clears = false;
+          }
+        }
+        if (clears && deg >= 2) { fv = j; fe = e; }
+      }
+    }
+    if (fv < 0) break;
+    code[fv] ^= fe;
+    for (int i = 0; i < BCNV3_M; ++i) {
+      for (int kk = 0; kk < BCNV3_DC; ++kk) {
+        if (H_idx_raw[i][kk] != fv) continue;
+        synd[i] ^= gf64::mul(H_ele_raw[i][kk], fe);
+        if (synd[i] == 0) --nbad;
+      }
+    }
+  }
+  return nbad;
+}
+
+static bool bcnv3_parity_ok(const uint8_t* code) {
+  for (int r = 0; r < BCNV3_M; ++r) {
+    uint8_t s = 0;
+    for (int k = 0; k < BCNV3_DC; ++k) s ^= gf64::mul(H_ele_raw[r][k], code[H_idx_raw[r][k]]);
+    if (s != 0) return false;
+  }
+  return true;
+}
+
+static int bcnv3_bit_errors(const uint8_t* a, const uint8_t* b) {
+  int nerr = 0;
+  for (int i = 0; i < BCNV3_N; ++i) nerr += __builtin_popcount(uint32_t((a[i] ^ b[i]) & 0x3F));
+  return nerr;
+}
+
+// Body of decode_batch(), force-inlined into one wrapper per kernel path.
+static inline SBFCO_KERNEL_INLINE void bcnv3_batch_decode(const SBFcoDecoder::Page* pages,
+                                                         SBFcoDecoder::Result* results,
+                                                         int count,
+                                                         const SBFcoDecoder::Config& config) {
+  const int W = SBFcoDecoder::BATCH_LANES;
+  const int Q_GF = 64;
+  const int NE = BCNV3_M * BCNV3_DC;
+  const int MAX_ITER = std::max(config.maxIter, 1);
+  const double ERR_PROB = (config.errProb > 0.0 && config.errProb < 0.5) ? config.errProb : 1e-5;
+  const float INF = 1e30f;
+  if (!pages || !results || count <= 0) return;
+
+  // Edge e = r * DC + k. The variable side of every edge, and the edge list of
+  // every variable, come from the same H_idx_raw/H_ele_raw as the scalar path.
+  int colEdge[BCNV3_N][BCNV3_DV];
+  int colDeg[BCNV3_N] = {0};
+  for (int r = 0; r < BCNV3_M; ++r) {
+    for (int k = 0; k < BCNV3_DC; ++k) {
+      int j = H_idx_raw[r][k];
+      if (colDeg[j] < BCNV3_DV) colEdge[j][colDeg[j]++] = r * BCNV3_DC + k;
+    }
+  }
+
+  // Lane-interleaved messages: [node/edge][GF symbol][lane].
+  auto at = [&](int node, int x) { return (size_t(node) * Q_GF + size_t(x)) * W; };
+  std::vector<float> L(size_t(BCNV3_N) * Q_GF * W, 0.0f);
+  std::vector<float> V2C(size_t(NE) * Q_GF * W, 0.0f);
+  std::vector<float> C2V(size_t(NE) * Q_GF * W, 0.0f);
+  std::vector<float> fwd(size_t(BCNV3_DC) * Q_GF * W), bwd(size_t(BCNV3_DC) * Q_GF * W);
+  std::vector<float> post(size_t(Q_GF) * W);
+
+  int lanePage[W];
+  int laneIter[W];
+  uint8_t laneCode[W][BCNV3_N];
+  int next = 0;
+  int active = 0;
+
+  auto finish = [&](int page, const uint8_t* code, int iterations, bool ok) {
+    SBFcoDecoder::Result& res = results[page];
+    memcpy(res.syms, code, BCNV3_N);
+    res.nerr = ok ? bcnv3_bit_errors(code, pages[page].syms) : -1;
+    res.iterations = iterations;
+  };
+  // Pull pages until one needs message passing; pages that pass the
+  // hard-decision check never occupy a lane.
+  auto load = [&](int w) {
+    while (next < count) {
+      int page = next++;
+      uint8_t code[BCNV3_N];
+      for (int j = 0; j < BCNV3_N; ++j) code[j] = uint8_t(pages[page].syms[j] & 0x3F);
+      if (bcnv3_hard_fix(code, BCNV3_FAST_FLIPS) == 0) {
+        finish(page, code, 0, true);
+        continue;
+      }
+      lanePage[w] = page;
+      laneIter[w] = 0;
+      const float llr = float(-std::log(ERR_PROB));
+      for (int j = 0; j < BCNV3_N; ++j) {
+        uint8_t c = uint8_t(pages[page].syms[j] & 0x3F);
+        laneCode[w][j] = c;
+        for (int x = 0; x < Q_GF; ++x) L[at(j, x) + w] = llr * float(__builtin_popcount(uint32_t(c ^ x)));
+      }
+      for (int e = 0; e < NE; ++e) {
+        int j = H_idx_raw[e / BCNV3_DC][e % BCNV3_DC];
+        uint8_t h = H_ele_raw[e / BCNV3_DC][e % BCNV3_DC];
+        for (int x = 0; x < Q_GF; ++x) V2C[at(e, gf64::mul(h, uint8_t(x))) + w] = L[at(j, x) + w];
+      }
+      return true;
+    }
+    lanePage[w] = -1;
+    return false;
+  };
+  // out = min-plus convolution of a and b over GF(2^6) addition (XOR), per lane.
+  // One lane group is a single vector, so each kernel path gets registers of
+  // its own width (two xmm on the baseline, one ymm on AVX2).
+  typedef float Lanes __attribute__((vector_size(sizeof(float) * SBFcoDecoder::BATCH_LANES)));
+  auto conv = [&](float* out, const float* a, const float* b) {
+    Lanes acc[Q_GF];
+    for (int x = 0; x < Q_GF; ++x) for (int w = 0; w < W; ++w) acc[x][w] = INF;
+    for (int xa = 0; xa < Q_GF; ++xa) {
+      Lanes va;
+      memcpy(&va, a + xa * W, sizeof(va));
+      for (int xb = 0; xb < Q_GF; ++xb) {
+        Lanes vb;
+        memcpy(&vb, b + xb * W, sizeof(vb));
+        Lanes s = va + vb;
+        Lanes& o = acc[xa ^ xb];
+        o = s < o ? s : o;
+      }
+    }
+    memcpy(out, acc, sizeof(acc));
+  };
+
+  for (int w = 0; w < W; ++w) if (load(w)) ++active;
+  while (active > 0) {
+    // Check nodes: forward/backward min-plus over the row, all lanes at once.
+    for (int r = 0; r < BCNV3_M; ++r) {
+      const int e0 = r * BCNV3_DC;
+      std::copy(&V2C[at(e0, 0)], &V2C[at(e0, 0)] + Q_GF * W, &fwd[0]);
+      std::copy(&V2C[at(e0 + BCNV3_DC - 1, 0)], &V2C[at(e0 + BCNV3_DC - 1, 0)] + Q_GF * W,
+                &bwd[size_t(BCNV3_DC - 1) * Q_GF * W]);
+      for (int k = 1; k < BCNV3_DC - 1; ++k) {
+        conv(&fwd[size_t(k) * Q_GF * W], &fwd[size_t(k - 1) * Q_GF * W], &V2C[at(e0 + k, 0)]);
+      }
+      for (int k = BCNV3_DC - 2; k >= 1; --k) {
+        conv(&bwd[size_t(k) * Q_GF * W], &bwd[size_t(k + 1) * Q_GF * W], &V2C[at(e0 + k, 0)]);
+      }
+      for (int k = 0; k < BCNV3_DC; ++k) {
+        float* ls = &post[0];
+        if (k == 0) std::copy(&bwd[size_t(1) * Q_GF * W], &bwd[size_t(1) * Q_GF * W] + Q_GF * W, ls);
+        else if (k == BCNV3_DC - 1) std::copy(&fwd[size_t(k - 1) * Q_GF * W], &fwd[size_t(k - 1) * Q_GF * W] + Q_GF * W, ls);
+        else conv(ls, &fwd[size_t(k - 1) * Q_GF * W], &bwd[size_t(k + 1) * Q_GF * W]);
+        float mn[W];
+        for (int w = 0; w < W; ++w) mn[w] = INF;
+        for (int x = 0; x < Q_GF; ++x) for (int w = 0; w < W; ++w) mn[w] = std::min(mn[w], ls[x * W + w]);
+        uint8_t h = H_ele_raw[r][k];
+        for (int x = 0; x < Q_GF; ++x) {
+          const float* src = ls + gf64::mul(h, uint8_t(x)) * W;
+          float* dst = &C2V[at(e0 + k, x)];
+          for (int w = 0; w < W; ++w) dst[w] = src[w] - mn[w];
+        }
+      }
+    }
+    // Variable nodes: extrinsic V2C and posterior hard decision per lane.
+    for (int j = 0; j < BCNV3_N; ++j) {
+      for (int x = 0; x < Q_GF; ++x) {
+        float* p = &post[size_t(x) * W];
+        const float* l = &L[at(j, x)];
+        for (int w = 0; w < W; ++w) p[w] = l[w];
+        for (int d = 0; d < colDeg[j]; ++d) {
+          const float* c = &C2V[at(colEdge[j][d], x)];
+          for (int w = 0; w < W; ++w) p[w] += c[w];
+        }
+      }
+      for (int d = 0; d < colDeg[j]; ++d) {
+        const int e = colEdge[j][d];
+        const uint8_t h = H_ele_raw[e / BCNV3_DC][e % BCNV3_DC];
+        float mn[W];
+        for (int w = 0; w < W; ++w) mn[w] = INF;
+        for (int x = 0; x < Q_GF; ++x) {
+          const float* p = &post[size_t(x) * W];
+          const float* c = &C2V[at(e, x)];
+          for (int w = 0; w < W; ++w) mn[w] = std::min(mn[w], p[w] - c[w]);
+        }
+        for (int x = 0; x < Q_GF; ++x) {
+          const float* p = &post[size_t(x) * W];
+          const float* c = &C2V[at(e, x)];
+          float* v = &V2C[at(e, gf64::mul(h, uint8_t(x)))];
+          for (int w = 0; w < W; ++w) v[w] = p[w] - c[w] - mn[w];
+        }
+      }
+      for (int w = 0; w < W; ++w) {
+        int argmin = 0;
+        for (int x = 1; x < Q_GF; ++x) if (post[size_t(x) * W + w] < post[size_t(argmin) * W + w]) argmin = x;
+        laneCode[w][j] = uint8_t(argmin);
+      }
+    }
+    // Retire converged or exhausted lanes and refill them from the queue.
+    for (int w = 0; w < W; ++w) {
+      if (lanePage[w] < 0) continue;
+      ++laneIter[w];
+      bool ok = bcnv3_parity_ok(laneCode[w]);
+      if (!ok && laneIter[w] < MAX_ITER) continue;
+      finish(lanePage[w], laneCode[w], laneIter[w], ok);
+      if (!load(w)) --active;
+    }
+  }
+}
+
+// Kernel paths: the batch decoder compiled for the baseline ISA and for
+// AVX2. AVX-512 hosts take the AVX2 path; eight float lanes fill one ymm
+// register and the zmm variants measured no faster.
+typedef void (*BCNV3BatchKernel)(const SBFcoDecoder::Page*, SBFcoDecoder::Result*, int,
+                                 const SBFcoDecoder::Config&);
+struct BCNV3Kernels {
+  SBFcoDecoder::KernelPath path;
+  BCNV3BatchKernel batch;
+};
+
+static void bcnv3_batch_scalar(const SBFcoDecoder::Page* pages, SBFcoDecoder::Result* results, int count,
+                               const SBFcoDecoder::Config& config) {
+  bcnv3_batch_decode(pages, results, count, config);
+}
+
+#ifdef SBFCO_X86_DISPATCH
+__attribute__((target("avx2")))
+static void bcnv3_batch_avx2(const SBFcoDecoder::Page* pages, SBFcoDecoder::Result* results, int count,
+                             const SBFcoDecoder::Config& config) {
+  bcnv3_batch_decode(pages, results, count, config);
+}
+#endif
+
+static BCNV3Kernels bcnv3_select_kernels() {
+  BCNV3Kernels k = {SBFcoDecoder::KERNEL_SCALAR, bcnv3_batch_scalar};
+  const char* force = getenv("SBFCO_FORCE_SCALAR");
+  if (force && *force && strcmp(force, "0") != 0) return k;
+#ifdef SBFCO_X86_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    k.path = SBFcoDecoder::KERNEL_AVX2;
+    k.batch = bcnv3_batch_avx2;
+  }
+#endif
+  return k;
+}
+
+static const BCNV3Kernels& bcnv3_kernels() {
+  static const BCNV3Kernels kernels = bcnv3_select_kernels();
+  return kernels;
+}
+
+SBFcoDecoder::KernelPath SBFcoDecoder::batchKernelPath() {
+  return bcnv3_kernels().path;
+}
+
+const char* SBFcoDecoder::batchKernelPathName() {
+  switch (batchKernelPath()) {
+    case KERNEL_AVX2: return "avx2";
+    case KERNEL_SCALAR: break;
+  }
+  return "scalar";
+}
+
+std::pair<std::vector<uint8_t>, int> SBFcoDecoder::decode_LDPC_BCNV3_bits(const std::vector<std::vector<int>>& H_idx,
+                                                                          const std::vector<std::vector<uint8_t>>& H_ele,
+                                                                          int m,
+                                                                          int n,
+                                                                          const std::vector<uint8_t>& syms,
+                                                                          int* iterations,
+                                                                          const Config& config,
+                                                                          const std::vector<float>* bitWeight) {
+  return bcnv3_ems_decode(H_idx, H_ele, m, n, syms, iterations, config, bitWeight);
+}
+
+void SBFcoDecoder::decode_batch(const Page* pages, Result* results, int count, const Config& config) {
+  bcnv3_kernels().batch(pages, results, count, config);
+}
+
+// Message-passing decode of one page into result
+static void bcnv3_ems_page(const SBFcoDecoder::Page& page, SBFcoDecoder::Result& result,
+                           const SBFcoDecoder::Config& config) {
+  std::vector<uint8_t> bits(size_t(BCNV3_N) * 6);
+  for (int i = 0; i < BCNV3_N; ++i) {
+    for (int b = 0; b < 6; ++b) bits[i * 6 + b] = uint8_t((page.syms[i] >> (5 - b)) & 1);
+  }
+  const BCNV3Tables& H = bcnv3_tables();
+  int iterations = 0;
+  auto decPair = bcnv3_ems_decode(H.idx, H.ele, BCNV3_M, BCNV3_N, bits, &iterations, config, nullptr);
+  for (int i = 0; i < BCNV3_N; ++i) {
+    uint8_t v = 0;
+    for (int b = 0; b < 6; ++b) v = uint8_t((v << 1) | (decPair.first[i * 6 + b] & 1));
+    result.syms[i] = v;
+  }
+  result.nerr = decPair.second;
+  result.iterations = iterations;
+}
+
+void SBFcoDecoder::decode_page(const Page& page, Result& result, const Config& config) {
+  // Clean and lightly damaged pages settle here, without allocating
+  for (int i = 0; i < BCNV3_N; ++i) result.syms[i] = uint8_t(page.syms[i] & 0x3F);
+  if (bcnv3_hard_fix(result.syms, BCNV3_FAST_FLIPS) == 0) {
+    result.nerr = bcnv3_bit_errors(page.syms, result.syms);
+    result.iterations = 0;
+    return;
+  }
+  bcnv3_ems_page(page, result, config);
+}
+
+void SBFcoDecoder::decode_page_reference(const Page& page, Result& result, const Config& config) {
+  // The original decode_LDPC_BCNV3_bits(), kept apart from the tuned kernel:
+  // own GF(64) tables, edge scans instead of adjacency lists, a full parity
+  // check per iteration, unscaled EMS messages and no fast path. Only the
+  // limits come from config.
+  const int Q_GF = 64;
+  const int MAX_ITER = std::max(config.maxIter, 1);
+  const int NM_EMS = std::min(std::max(config.nmEms, 1), Q_GF);
+  const double ERR_PROB = (config.errProb > 0.0 && config.errProb < 0.5) ? config.errProb : 1e-5;
+  static const uint8_t GF_VEC[63] = {1,2,4,8,16,32,3,6,12,24,48,35,5,10,20,40,19,38,15,30,60,59,53,41,17,34,7,14,28,56,51,37,9,18,36,11,22,44,27,54,47,29,58,55,45,25,50,39,13,26,52,43,21,42,23,46,31,62,63,61,57,49,33};
+  static const uint8_t GF_POW[64] = {0,0,1,6,2,12,7,26,3,32,13,35,8,48,27,18,4,24,33,16,14,52,36,54,9,45,49,38,28,41,19,56,5,62,25,11,34,31,17,47,15,23,53,51,37,44,55,40,10,61,46,30,50,22,39,43,29,60,42,21,20,59,57,58};
+  uint8_t GF_MUL[Q_GF][Q_GF];
+  for (int i = 0; i < Q_GF; ++i) {
+    for (int j = 0; j < Q_GF; ++j) {
+      GF_MUL[i][j] = (i == 0 || j == 0) ? 0 : GF_VEC[(GF_POW[i] + GF_POW[j]) % (Q_GF - 1)];
+    }
+  }
+  const int nvars = BCNV3_N;
+  std::vector<uint8_t> code(nvars, 0);
+  for (int i = 0; i < nvars; ++i) code[i] = uint8_t(page.syms[i] & 0x3F);
+  auto bitcnt6 = [&](uint8_t x) { return int(__builtin_popcount(uint32_t(x & 0x3F))); };
+  std::vector<int> ie;
+  std::vector<int> je;
+  std::vector<uint8_t> he;
+  std::vector<std::vector<float>> L(nvars, std::vector<float>(Q_GF, 0.0f));
+  for (int i = 0; i < nvars; ++i) {
+    for (int j = 0; j < Q_GF; ++j) {
+      L[i][j] = float(-std::log(ERR_PROB) * bitcnt6(uint8_t(code[i] ^ j)));
+    }
+  }
+  for (int i = 0; i < BCNV3_M; ++i) {
+    for (int j = 0; j < BCNV3_DC; ++j) {
+      ie.push_back(i);
+      je.push_back(H_idx_raw[i][j]);
+      he.push_back(H_ele_raw[i][j]);
+    }
+  }
+  const int ne = int(ie.size());
+  std::vector<std::vector<float>> V2C(ne, std::vector<float>(Q_GF, 0.0f));
+  std::vector<std::vector<float>> C2V(ne, std::vector<float>(Q_GF, 0.0f));
   for (int i = 0; i < ne; ++i) {
     for (int x = 0; x < Q_GF; ++x) V2C[i][GF_MUL[he[i]][x]] = L[je[i]][x];
   }
   auto check_parity = [&]() {
-    std::vector<uint8_t> s(m, 0);
+    std::vector<uint8_t> s(BCNV3_M, 0);
     for (int i = 0; i < ne; ++i) s[ie[i]] ^= GF_MUL[he[i]][code[je[i]]];
-    for (int i = 0; i < m; ++i) if (s[i] != 0) return false;
+    for (int i = 0; i < BCNV3_M; ++i) if (s[i] != 0) return false;
     return true;
   };
   auto ext_min_sum = [&](const std::vector<float>& A, const std::vector<float>& B) {
@@ -298,13 +1026,17 @@ std::pair<std::vector<uint8_t>, int> SBFcoDecoder::decode_LDPC_BCNV3_bits(const
     }
     return Ls;
   };
+  auto finish = [&](int nerr, int it) {
+    for (int i = 0; i < nvars; ++i) result.syms[i] = code[i];
+    result.nerr = nerr;
+    result.iterations = it;
+  };
   for (int it = 0; it < MAX_ITER; ++it) {
     if (check_parity()) {
-      std::vector<uint8_t> syms_dec = gf2bin(code);
       int nerr = 0;
-      size_t Lmin = std::min(syms_dec.size(), syms.size());
-      for (size_t i = 0; i < Lmin; ++i) if ((syms_dec[i] ^ syms[i]) & 1) ++nerr;
-      return {syms_dec, nerr};
+      for (int i = 0; i < nvars; ++i) nerr += bitcnt6(uint8_t(code[i] ^ page.syms[i]));
+      finish(nerr, it);
+      return;
     }
     for (int i = 0; i < ne; ++i) {
       std::vector<float> Ls;
@@ -330,7 +1062,103 @@ std::pair<std::vector<uint8_t>, int> SBFcoDecoder::decode_LDPC_BCNV3_bits(const
       code[i] = uint8_t(argmin);
     }
   }
-  std::vector<uint8_t> syms_dec = gf2bin(code);
-  return {syms_dec, -1};
+  int nerr = -1;
+  if (check_parity()) {
+    nerr = 0;
+    for (int i = 0; i < nvars; ++i) nerr += bitcnt6(uint8_t(code[i] ^ page.syms[i]));
+  }
+  finish(nerr, MAX_ITER);
+}
+
+// Parity generator of the systematic BCNV3 code: with H = [Hs | Hp] split at
+// symbol 81, parity = Hp^-1 * Hs * info. Built once by Gaussian elimination.
+namespace {
+struct BCNV3Generator {
+  uint8_t P[BCNV3_M][BCNV3_N - BCNV3_M];
+  BCNV3Generator() {
+    const int K = BCNV3_N - BCNV3_M;
+    // Augmented [Hp | Hs], reduced to [I | Hp^-1 Hs].
+    uint8_t A[BCNV3_M][BCNV3_M + K];
+    memset(A, 0, sizeof(A));
+    for (int r = 0; r < BCNV3_M; ++r) {
+      for (int k = 0; k < BCNV3_DC; ++k) {
+        int j = H_idx_raw[r][k];
+        if (j >= K) A[r][j - K] = H_ele_raw[r][k];
+        else A[r][BCNV3_M + j] = H_ele_raw[r][k];
+      }
+    }
+    for (int c = 0; c < BCNV3_M; ++c) {
+      int piv = c;
+      while (piv < BCNV3_M && A[piv][c] == 0) ++piv;
+      if (piv == BCNV3_M) continue;  // Hp of BCNV3 is full rank; never taken
+      if (piv != c) {
+        for (int x = 0; x < BCNV3_M + K; ++x) std::swap(A[piv][x], A[c][x]);
+      }
+      uint8_t iv = gf64::inv(A[c][c]);
+      for (int x = 0; x < BCNV3_M + K; ++x) A[c][x] = gf64::mul(A[c][x], iv);
+      for (int r = 0; r < BCNV3_M; ++r) {
+        if (r == c || A[r][c] == 0) continue;
+        uint8_t f = A[r][c];
+        for (int x = 0; x < BCNV3_M + K; ++x) A[r][x] ^= gf64::mul(f, A[c][x]);
+      }
+    }
+    for (int r = 0; r < BCNV3_M; ++r) {
+      for (int j = 0; j < K; ++j) P[r][j] = A[r][BCNV3_M + j];
+    }
+  }
+};
+}
+
+void SBFcoDecoder::encode_BCNV3(const uint8_t info[81], uint8_t code[162]) {
+  static const BCNV3Generator gen;
+  const int K = BCNV3_N - BCNV3_M;
+  for (int j = 0; j < K; ++j) code[j] = uint8_t(info[j] & 0x3F);
+  for (int r = 0; r < BCNV3_M; ++r) {
+    uint8_t p = 0;
+    for (int j = 0; j < K; ++j) p ^= gf64::mul(gen.P[r][j], code[j]);
+    code[K + r] = p;
+  }
+}
+
+void SBFcoDecoder::LatencyBudget::setBase(const Config& base) {
+  _base = base;
+  _cur = base;
+  _avgNs = 0.0;
+  _hold = 0;
+}
+
+void SBFcoDecoder::LatencyBudget::setBudgetNs(int64_t budgetNs) {
+  _budgetNs = std::max<int64_t>(budgetNs, 0);
+  setBase(_base);
+}
+
+bool SBFcoDecoder::LatencyBudget::degraded() const {
+  return _budgetNs > 0 && (_cur.maxIter < _base.maxIter || _cur.nmEms < _base.nmEms);
 }
 
+void SBFcoDecoder::LatencyBudget::update(int64_t decodeNs) {
+  if (_budgetNs <= 0) return;
+  _avgNs = (_avgNs == 0.0) ? double(decodeNs) : _avgNs + (double(decodeNs) - _avgNs) / 8.0;
+  if (++_hold < HOLD_PAGES) return;
+  const int minIter = std::min(MIN_ITER, _base.maxIter);
+  const int minEms = std::min(MIN_EMS, _base.nmEms);
+  if (_avgNs > double(_budgetNs)) {
+    if (_cur.maxIter > minIter) {
+      _cur.maxIter = std::max(minIter, _cur.maxIter - std::max(1, _cur.maxIter / 4));
+    } else if (_cur.nmEms > minEms) {
+      --_cur.nmEms;
+    } else {
+      return;
+    }
+    _hold = 0;
+  } else if (_avgNs < 0.5 * double(_budgetNs)) {
+    if (_cur.nmEms < _base.nmEms) {
+      ++_cur.nmEms;
+    } else if (_cur.maxIter < _base.maxIter) {
+      _cur.maxIter = std::min(_base.maxIter, _cur.maxIter + std::max(1, _base.maxIter / 4));
+    } else {
+      return;
+    }
+    _hold = 0;
+  }
+}
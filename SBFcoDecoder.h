@@ -1,30 +1,164 @@
 #ifndef SBF_CO_DECODER_H
 #define SBF_CO_DECODER_H
 
+// Build with SBFCO_NO_QT for the Qt-free core (b2b_core): the hex/QByteArray
+// entry points are left out, the decoders and the encoder stay.
+#ifndef SBFCO_NO_QT
 #include <QByteArray>
 #include <QString>
+#endif
 #include <vector>
 #include <utility>
+#include <cstdint>
 
 class SBFcoDecoder {
 public:
-  static QByteArray decode_LDPC_navbitsRaw(const QByteArray& navBits);
+  // Outcome of one decode, for telemetry.
+  struct DecodeInfo {
+    int nerr = 0;              // corrected bits, -1 if parity still fails after maxIter
+    int iterations = 0;        // 0 when the hard-decision fast path settled the page
+    int symbolsCorrected = 0;  // GF(64) symbols changed by the decoder
+    bool truncated = false;    // set by the caller: parity failed under limits lowered by a LatencyBudget
+    int copies = 1;            // receptions combined into the decoder input
+  };
+
+  // Message-passing schedule of the EMS decoder.
+  enum Schedule {
+    SCHEDULE_FLOODING,  // check nodes, then variable nodes; satisfied, settled checks are frozen
+    SCHEDULE_LAYERED    // row-serial: posteriors updated right after each check row
+  };
+
+  // Check-node engine of decode_LDPC_BCNV3_bits(). Both schedules accept
+  // either engine; variable nodes always sum their incoming messages.
+  enum Engine {
+    ENGINE_EMS,      // extended min-sum: sum of the nmEms best candidates per input
+    ENGINE_MIN_MAX   // min-max: full 64x64 combination, cost of a path is its worst input
+  };
+
+  // Decoder limits; the defaults are the values the decoder was tuned with.
+  struct Config {
+    int maxIter;         // message-passing iterations before giving up
+    int nmEms;           // EMS truncation: candidates kept per message (1..64)
+    double errProb;      // channel bit error probability behind the initial LLRs
+    Schedule schedule;
+    Engine engine;
+    Config() : maxIter(15), nmEms(4), errProb(1e-5), schedule(SCHEDULE_FLOODING), engine(ENGINE_EMS) {}
+  };
+
+  // Steers a Config towards a per-page decode time budget. Each sample
+  // updates a smoothed decode time; above the budget the iteration cap is
+  // lowered first, then the EMS width; well below it they are raised back
+  // to the base config in reverse order. A budget of 0 disables control.
+  class LatencyBudget {
+  public:
+    void setBase(const Config& base);
+    void setBudgetNs(int64_t budgetNs);
+    const Config& base() const { return _base; }
+    int64_t budgetNs() const { return _budgetNs; }
+    const Config& current() const { return _budgetNs > 0 ? _cur : _base; }
+    // True while current() is below the base limits.
+    bool degraded() const;
+    void update(int64_t decodeNs);
+
+  private:
+    static constexpr int MIN_ITER = 3;
+    static constexpr int MIN_EMS = 2;
+    static constexpr int HOLD_PAGES = 8;  // samples between two adjustments
+    Config  _base;
+    Config  _cur;
+    int64_t _budgetNs = 0;
+    double  _avgNs = 0.0;
+    int     _hold = 0;
+  };
+
+#ifndef SBFCO_NO_QT
+  static QByteArray decode_LDPC_navbitsRaw(const QByteArray& navBits, DecodeInfo* info = nullptr,
+                                           const Config& config = Config());
+  // Same decode as decode_LDPC_navbitsRaw(), from the 31 NAVBits words
+  // instead of their hex text. A page the hard-decision fast path settles
+  // allocates nothing but the returned array.
+  static QByteArray decode_LDPC_navWords(const uint32_t* words, DecodeInfo* info = nullptr,
+                                         const Config& config = Config());
+  // Decode several receptions of one page, each given as its 31 raw NAVBits
+  // words. Bits are combined by majority vote and each bit's LLR is scaled by
+  // the vote margin, so agreeing copies reinforce each other and ties become
+  // erasures. A single copy decodes exactly like decode_LDPC_navbitsRaw().
+  // With copyErrProb (one bit error probability per copy, 0 = unknown, taken
+  // as config.errProb) each copy votes with its own log-likelihood ratio, so
+  // a strong channel outweighs weak ones instead of tying with them.
+  static QByteArray decode_LDPC_navWordsVoted(const std::vector<const uint32_t*>& copies,
+                                              DecodeInfo* info = nullptr, const Config& config = Config(),
+                                              const std::vector<double>* copyErrProb = nullptr);
+#endif
+
+  // Bit error probability of a B2b-I symbol (BPSK, 1000 sps) at the given
+  // C/N0 in dB-Hz, clamped to [1e-9, 0.25].
+  static double errProbFromCN0(double cn0DbHz);
+
+  // One BCNV3 codeword: 162 hard-decision GF(64) symbols, i.e. the 972 LDPC
+  // bits taken MSB-first in groups of 6.
+  struct Page {
+    uint8_t syms[162];
+  };
+  struct Result {
+    uint8_t syms[162];
+    int nerr;        // corrected bits, -1 if parity still fails after maxIter
+    int iterations;  // message-passing iterations, 0 for the hard-decision fast path
+  };
+  // Decode count pages, interleaving BATCH_LANES codewords across SIMD lanes
+  // with one shared Tanner-graph walk. Converged pages leave their lane and
+  // the next queued page takes it over.
+  // Only maxIter and errProb apply; the batch check update is full min-plus.
+  static void decode_batch(const Page* pages, Result* results, int count,
+                           const Config& config = Config());
+  static const int BATCH_LANES = 8;
+  // Decode one page through decode_LDPC_BCNV3_bits() with the given config.
+  static void decode_page(const Page& page, Result& result, const Config& config = Config());
+  // Reference decode for verifying the production paths: a separate copy of
+  // the original flooding EMS decoder (unscaled messages, full parity check
+  // per iteration, no fast path, no frozen checks) that shares no decoder
+  // code with decode_LDPC_BCNV3_bits(). Only maxIter, nmEms and errProb of
+  // config apply. Many times slower than decode_page().
+  static void decode_page_reference(const Page& page, Result& result, const Config& config = Config());
+
+  // Instruction-set path of decode_batch(), chosen once per process
+  // from CPUID. SBFCO_FORCE_SCALAR=1 in the environment pins the portable
+  // path for debugging. The per-page decoders always run the baseline build.
+  enum KernelPath {
+    KERNEL_SCALAR,
+    KERNEL_AVX2
+  };
+  static KernelPath batchKernelPath();
+  static const char* batchKernelPathName();
+
+  // Systematic BCNV3 encoder: code[0..80] = info, code[81..161] = parity.
+  static void encode_BCNV3(const uint8_t info[81], uint8_t code[162]);
 
 
 private:
+#ifndef SBFCO_NO_QT
   static std::vector<uint8_t> hexToBytesSanitized(const QString& hex);
   static QString bytesToHex(const std::vector<uint8_t>& bytes);
-  static std::vector<uint8_t> bytesToBitsBE(const std::vector<uint8_t>& bytes);
-  static std::vector<uint8_t> bitsToBytesBE(const std::vector<uint8_t>& bits);
   static QString bitsToHex(const std::vector<uint8_t>& bits);
-  static std::pair<std::vector<uint8_t>, int> decode_LDPC_BCNV3(const std::vector<uint8_t>& errData);
   static std::vector<uint8_t> read_hex_bits(const QString& hex);
   static QString hex_str_from_bits(const std::vector<uint8_t>& bits);
+#endif
+  static std::vector<uint8_t> bytesToBitsBE(const std::vector<uint8_t>& bytes);
+  static std::vector<uint8_t> bitsToBytesBE(const std::vector<uint8_t>& bits);
+  static std::pair<std::vector<uint8_t>, int> decode_LDPC_BCNV3(const std::vector<uint8_t>& errData);
   static std::pair<std::vector<uint8_t>, int> decode_LDPC_BCNV3_bits(const std::vector<std::vector<int>>& H_idx,
                                                                       const std::vector<std::vector<uint8_t>>& H_ele,
                                                                       int m,
                                                                       int n,
-                                                                      const std::vector<uint8_t>& syms);
+                                                                      const std::vector<uint8_t>& syms,
+                                                                      int* iterations = nullptr,
+                                                                      const Config& config = Config(),
+                                                                      const std::vector<float>* bitWeight = nullptr);
+  // Decode the 972 LDPC bits of one page and fill info.
+  static std::vector<uint8_t> decode_page_bits(const std::vector<uint8_t>& bits,
+                                               const std::vector<float>* bitWeight,
+                                               DecodeInfo* info,
+                                               const Config& config);
 
 };
 
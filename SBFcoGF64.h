@@ -0,0 +1,68 @@
+#ifndef SBF_CO_GF64_H
+#define SBF_CO_GF64_H
+
+#include <cstdint>
+
+// GF(2^6) arithmetic for the BCNV3 LDPC code (primitive polynomial x^6 + x + 1).
+// Every table is generated at compile time, so decoders running on several
+// threads share them without locks or first-call initialisation.
+namespace gf64 {
+
+constexpr int Q = 64;
+constexpr int ORDER = Q - 1;
+
+struct Tables {
+  uint8_t exp[2 * ORDER];  // antilog, repeated once so exp[log a + log b] needs no modulo
+  uint8_t log[Q];          // log[0] is unused and left 0
+  uint8_t inv[Q];          // inv[0] is unused and left 0
+  uint8_t mul[Q * Q];      // mul[a * Q + b] = a * b
+};
+
+constexpr Tables makeTables() {
+  Tables t{};
+  unsigned v = 1;
+  for (int i = 0; i < ORDER; ++i) {
+    t.exp[i] = uint8_t(v);
+    t.exp[i + ORDER] = uint8_t(v);
+    t.log[v] = uint8_t(i);
+    v <<= 1;
+    if (v & 0x40) v ^= 0x43;
+  }
+  for (int a = 1; a < Q; ++a) {
+    t.inv[a] = t.exp[(ORDER - t.log[a]) % ORDER];
+    for (int b = 1; b < Q; ++b) t.mul[a * Q + b] = t.exp[t.log[a] + t.log[b]];
+  }
+  return t;
+}
+
+inline constexpr Tables TABLES = makeTables();
+
+constexpr uint8_t add(uint8_t a, uint8_t b) { return uint8_t(a ^ b); }
+constexpr uint8_t mul(uint8_t a, uint8_t b) { return TABLES.mul[(a & 0x3F) * Q + (b & 0x3F)]; }
+constexpr uint8_t inv(uint8_t a) { return TABLES.inv[a & 0x3F]; }
+constexpr uint8_t div(uint8_t a, uint8_t b) { return mul(a, inv(b)); }
+
+// Field element wrapper for code that reads better with operators.
+class GF64 {
+ public:
+  constexpr GF64() : _v(0) {}
+  constexpr explicit GF64(uint8_t v) : _v(uint8_t(v & 0x3F)) {}
+  constexpr uint8_t value() const { return _v; }
+  constexpr GF64 operator+(GF64 o) const { return GF64(add(_v, o._v)); }
+  constexpr GF64 operator-(GF64 o) const { return GF64(add(_v, o._v)); }
+  constexpr GF64 operator*(GF64 o) const { return GF64(mul(_v, o._v)); }
+  constexpr GF64 operator/(GF64 o) const { return GF64(div(_v, o._v)); }
+  constexpr GF64 inverse() const { return GF64(inv(_v)); }
+  constexpr bool operator==(GF64 o) const { return _v == o._v; }
+  constexpr bool operator!=(GF64 o) const { return _v != o._v; }
+ private:
+  uint8_t _v;
+};
+
+static_assert(mul(32, 2) == 3, "x^6 must reduce to x + 1");
+static_assert(mul(inv(37), 37) == 1, "inverse table");
+static_assert((GF64(19) * GF64(44) / GF64(44)) == GF64(19), "field division");
+
+}  // namespace gf64
+
+#endif
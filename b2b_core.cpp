@@ -0,0 +1,539 @@
+// Qt-free B2b core behind the C ABI declared in b2b_core.h
+
+#include "b2b_core.h"
+#include "SBFcoDecoder.h"
+
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace {
+
+// Bits [pos, pos+len) of a message, MSB first, 1 <= len <= 32: one 64-bit
+// big-endian window from byte pos/8, so any field fits after the sub-byte
+// shift. Windows reaching past the page are zero-filled, never over-read.
+inline uint64_t window(const uint8_t* buff, int pos) {
+    const int byte = pos >> 3;
+    uint64_t w = 0;
+    if (byte + 8 <= B2B_MSG_BYTES) {
+        const uint8_t* b = buff + byte;
+        w = uint64_t(b[0]) << 56 | uint64_t(b[1]) << 48 | uint64_t(b[2]) << 40 | uint64_t(b[3]) << 32 |
+            uint64_t(b[4]) << 24 | uint64_t(b[5]) << 16 | uint64_t(b[6]) << 8 | uint64_t(b[7]);
+        return w << (pos & 7);
+    }
+    for (int i = byte; i < B2B_MSG_BYTES; ++i) w = (w << 8) | buff[i];
+    return (w << 8 * (byte + 8 - B2B_MSG_BYTES)) << (pos & 7);
+}
+
+inline uint32_t getbitu(const uint8_t* buff, int pos, int len) {
+    return uint32_t(window(buff, pos) >> (64 - len));
+}
+
+inline int32_t getbits(const uint8_t* buff, int pos, int len) {
+    return int32_t(int64_t(window(buff, pos)) >> (64 - len));  /* extend sign */
+}
+
+// One message field: width in bits, two's complement or not, and the LSB
+// value for scaled fields (0 = raw integer). A Layout packs its fields back
+// to back in table order, so offsets and sizes are derived, not written.
+struct Field {
+    int len;
+    bool sign;
+    double scale;
+};
+
+template<int N>
+struct Layout {
+    Field f[N];
+    constexpr int offset(int k) const {
+        int o = 0;
+        for (int i = 0; i < k; ++i) o += f[i].len;
+        return o;
+    }
+    constexpr int bits() const { return offset(N); }
+    constexpr bool valid() const {
+        for (int i = 0; i < N; ++i) {
+            if (f[i].len < 1 || f[i].len > 32) return false;
+        }
+        return true;
+    }
+};
+
+// Field K of layout L for the block starting at bit base
+template<const auto& L, int K>
+inline int32_t raw(const uint8_t* buff, int base) {
+    static_assert(L.valid(), "B2b field width must be 1..32 bits");
+    constexpr Field f = L.f[K];
+    constexpr int off = L.offset(K);
+    return f.sign ? getbits(buff, base + off, f.len) : int32_t(getbitu(buff, base + off, f.len));
+}
+
+// Store field K into dst: scaled fields need a floating-point target, integer
+// fields one wide enough for every value the field can take.
+template<const auto& L, int K, typename T>
+inline void get(T& dst, const uint8_t* buff, int base) {
+    constexpr Field f = L.f[K];
+    if constexpr (std::is_floating_point<T>::value) {
+        dst = f.scale != 0.0 ? raw<L, K>(buff, base) * f.scale : T(raw<L, K>(buff, base));
+    } else {
+        static_assert(f.scale == 0.0, "scaled B2b field stored as an integer");
+        static_assert(f.sign ? std::is_signed<T>::value && f.len - 1 <= std::numeric_limits<T>::digits
+                             : f.len <= std::numeric_limits<T>::digits,
+                      "B2b field does not fit its destination");
+        dst = T(raw<L, K>(buff, base));
+    }
+}
+
+// Common message header, and the CRC-24Q trailer after the data field
+enum { HDR_TYPE, HDR_SOD, HDR_NUDATA, HDR_SSR };
+constexpr Layout<4> HEADER = {{{6, false, 0}, {17, false, 0}, {4, false, 0}, {2, false, 0}}};
+constexpr int DATA_BITS = B2B_MSG_BITS - 24;
+
+// Satellite orbit correction, MT2 and the orbit part of MT6/MT7
+enum { ORB_SLOT, ORB_IODN, ORB_IODCORR, ORB_RADIAL, ORB_ALONG, ORB_CROSS, ORB_URA };
+constexpr Layout<7> ORBIT = {{{9, false, 0}, {10, false, 0}, {3, false, 0}, {15, true, 0.0016},
+                              {13, true, 0.0064}, {13, true, 0.0064}, {6, false, 0}}};
+constexpr int MT2_SATS = 6;
+constexpr Layout<1> MT2_TAIL = {{{19, false, 0}}};
+static_assert(HEADER.bits() + MT2_SATS * ORBIT.bits() + MT2_TAIL.bits() == DATA_BITS, "MT2 layout");
+
+// MT1 satellite mask
+enum { MT1_IODP };
+constexpr Layout<1> MT1 = {{{4, false, 0}}};
+constexpr int MT1_MASK_BITS = 255;
+static_assert(MT1_MASK_BITS <= 64 * int(sizeof(b2b::Mt1::prn_mask) / sizeof(uint64_t)), "MT1 mask words");
+constexpr int MT1_REV_BITS = 174;
+static_assert(HEADER.bits() + MT1.bits() + MT1_MASK_BITS + MT1_REV_BITS == DATA_BITS, "MT1 layout");
+
+// MT3 code bias: a satellite block, then num4 (pattern, bias) pairs
+enum { MT3_NUM };
+constexpr Layout<1> MT3 = {{{5, false, 0}}};
+enum { DCB_SLOT, DCB_NUM };
+constexpr Layout<2> MT3_SAT = {{{9, false, 0}, {4, false, 0}}};
+enum { DCB_PATTERN, DCB_BIAS };
+constexpr Layout<2> MT3_BIAS = {{{4, false, 0}, {12, true, 0.017}}};
+static_assert((DATA_BITS - HEADER.bits() - MT3.bits() - MT3_SAT.bits()) / MT3_BIAS.bits() <= B2B_MT3_MAX_BIASES,
+              "MT3 bias pool");
+
+// MT4 clock correction for 23 consecutive mask entries
+enum { MT4_IODP, MT4_SUBTYPE };
+constexpr Layout<2> MT4 = {{{4, false, 0}, {5, false, 0}}};
+enum { CLK_IODCORR, CLK_C0 };
+constexpr Layout<2> MT4_CLK = {{{3, false, 0}, {15, true, 0.0016}}};
+constexpr int MT4_SATS = 23;
+constexpr Layout<1> MT4_TAIL = {{{10, false, 0}}};
+static_assert(HEADER.bits() + MT4.bits() + MT4_SATS * MT4_CLK.bits() + MT4_TAIL.bits() == DATA_BITS, "MT4 layout");
+
+// MT5 URA for 70 consecutive mask entries
+enum { MT5_IODP, MT5_SUBTYPE };
+constexpr Layout<2> MT5 = {{{4, false, 0}, {3, false, 0}}};
+enum { URA_CLASS, URA_VALUE };
+constexpr Layout<2> MT5_URA = {{{3, false, 0}, {3, false, 0}}};
+constexpr int MT5_SATS = 70;
+static_assert(HEADER.bits() + MT5.bits() + MT5_SATS * MT5_URA.bits() <= DATA_BITS, "MT5 layout");
+
+// MT6/MT7 combination: counts, a clock group, then an orbit group
+enum { COMB_NUMC, COMB_NUMO };
+constexpr Layout<2> COMB = {{{5, false, 0}, {3, false, 0}}};
+enum { MT6CLK_TOC, MT6CLK_DEV, MT6CLK_IODSSR, MT6CLK_IODP, MT6CLK_SLOTS };
+constexpr Layout<5> MT6_CLKHDR = {{{17, false, 0}, {4, false, 0}, {2, false, 0}, {4, false, 0}, {9, false, 0}}};
+enum { MT7CLK_TOC, MT7CLK_DEV, MT7CLK_IODSSR };
+constexpr Layout<3> MT7_CLKHDR = {{{17, false, 0}, {4, false, 0}, {2, false, 0}}};
+enum { MT7CLK_SLOT };
+constexpr Layout<1> MT7_SLOT = {{{9, false, 0}}};
+enum { ORBHDR_TOT, ORBHDR_DEV, ORBHDR_IODSSR };
+constexpr Layout<3> COMB_ORBHDR = {{{17, false, 0}, {4, false, 0}, {2, false, 0}}};
+
+// sigma_URA = 3^class * (1 + value/4) - 1 in mm, indexed by the 6-bit
+// (class, value) field
+struct UraTable {
+    double v[64];
+    constexpr UraTable() : v() {
+        double p = 1.0;
+        for (int cls = 0; cls < 8; ++cls, p *= 3.0) {
+            for (int val = 0; val < 8; ++val) v[cls * 8 + val] = p * (1 + 0.25 * val) - 1;
+        }
+    }
+};
+constexpr UraTable URA;
+
+// n <= 256 bits from pos into 64-bit words, MSB first, unused bits clear
+void read_bitset(const uint8_t* buff, int pos, int n, uint64_t* out) {
+    for (int a = 0, w = 0; a < n; a += 64, ++w) {
+        int hi = n - a < 32 ? n - a : 32;
+        int lo = n - a - hi < 32 ? n - a - hi : 32;
+        uint64_t v = uint64_t(getbitu(buff, pos + a, hi)) << (64 - hi);
+        if (lo > 0) v |= uint64_t(getbitu(buff, pos + a + hi, lo)) << (32 - lo);
+        out[w] = v;
+    }
+}
+
+// Expand n single-bit fields from pos into one byte each
+void unpack_bits(const uint8_t* buff, int pos, int n, char* out) {
+    for (int a = 0; a < n; a += 32) {
+        int len = n - a < 32 ? n - a : 32;
+        uint32_t w = getbitu(buff, pos + a, len);
+        for (int i = 0; i < len; ++i) out[a + i] = char((w >> (len - 1 - i)) & 1u);
+    }
+}
+
+void parse_header(const uint8_t* buff, b2b::Header& h) {
+    get<HEADER, HDR_TYPE>(h.type, buff, 0);
+    get<HEADER, HDR_SOD>(h.sod, buff, 0);
+    get<HEADER, HDR_NUDATA>(h.nudata, buff, 0);
+    get<HEADER, HDR_SSR>(h.ssr, buff, 0);
+    h.crc = int(getbitu(buff, DATA_BITS, 24));
+}
+
+void parse_orbit(const uint8_t* buff, int r, b2b::Orbit* t) {
+    get<ORBIT, ORB_SLOT>(t->slot, buff, r);
+    get<ORBIT, ORB_IODN>(t->iodn, buff, r);
+    get<ORBIT, ORB_IODCORR>(t->iodcorr, buff, r);
+    get<ORBIT, ORB_RADIAL>(t->radial, buff, r);
+    get<ORBIT, ORB_ALONG>(t->along, buff, r);
+    get<ORBIT, ORB_CROSS>(t->cross, buff, r);
+    int ura = raw<ORBIT, ORB_URA>(buff, r);
+    t->uraClass = (unsigned char)(ura >> 3);
+    t->uraValue = (unsigned char)(ura & 7);
+    t->ura = float(URA.v[ura]);
+}
+
+// MT6/MT7 body: counts, the clock group, then the orbit group. Both groups
+// stop at their array size and at the end of the data field.
+void parse_comb(const uint8_t* buff, int r, bool mt7, b2b::Combined& m) {
+    int numc = raw<COMB, COMB_NUMC>(buff, r);
+    int numo = raw<COMB, COMB_NUMO>(buff, r);
+    r += COMB.bits();
+    int slotBits = 0;
+    if (mt7) {
+        get<MT7_CLKHDR, MT7CLK_TOC>(m.toc, buff, r);
+        get<MT7_CLKHDR, MT7CLK_DEV>(m.clkDev, buff, r);
+        get<MT7_CLKHDR, MT7CLK_IODSSR>(m.clkIodSsr, buff, r);
+        m.iodp = 0;
+        m.firstSlot = 0;
+        r += MT7_CLKHDR.bits();
+        slotBits = MT7_SLOT.bits();
+    } else {
+        get<MT6_CLKHDR, MT6CLK_TOC>(m.toc, buff, r);
+        get<MT6_CLKHDR, MT6CLK_DEV>(m.clkDev, buff, r);
+        get<MT6_CLKHDR, MT6CLK_IODSSR>(m.clkIodSsr, buff, r);
+        get<MT6_CLKHDR, MT6CLK_IODP>(m.iodp, buff, r);
+        get<MT6_CLKHDR, MT6CLK_SLOTS>(m.firstSlot, buff, r);
+        r += MT6_CLKHDR.bits();
+    }
+    const int step = slotBits + MT4_CLK.bits();
+    int a = 0;
+    for (; a < numc && a < 22 && r + step <= DATA_BITS; ++a, r += step) {
+        b2b::Clock& c = m.clk[a];
+        if (mt7) get<MT7_SLOT, MT7CLK_SLOT>(c.slot, buff, r);
+        else c.slot = 0;
+        get<MT4_CLK, CLK_IODCORR>(c.iodcorr, buff, r + slotBits);
+        get<MT4_CLK, CLK_C0>(c.c0, buff, r + slotBits);
+    }
+    m.numc = (unsigned char)a;
+
+    get<COMB_ORBHDR, ORBHDR_TOT>(m.tot, buff, r);
+    get<COMB_ORBHDR, ORBHDR_DEV>(m.orbDev, buff, r);
+    get<COMB_ORBHDR, ORBHDR_IODSSR>(m.orbIodSsr, buff, r);
+    r += COMB_ORBHDR.bits();
+    a = 0;
+    for (; a < numo && a < 6 && r + ORBIT.bits() <= DATA_BITS; ++a, r += ORBIT.bits()) {
+        parse_orbit(buff, r, &m.orb[a]);
+    }
+    m.numo = (unsigned char)a;
+}
+
+// Typed orbit back to the C struct of b2b_parse_page()
+void to_trackcp(const b2b::Orbit& o, Trackcp* t) {
+    t->satslot = o.slot;
+    t->IODN = o.iodn;
+    t->IODCorr = o.iodcorr;
+    t->radial = o.radial;
+    t->Tangentialdir = o.along;
+    t->Normaldir = o.cross;
+    t->URAclass = o.uraClass;
+    t->URAvalue = o.uraValue;
+    t->ura = URA.v[o.uraClass * 8 + o.uraValue];
+}
+
+// Raw C0 count of a parsed clock, as ppp_sub6/ppp_sub7 keep it
+int raw_c0(float c0) {
+    return int(c0 / MT4_CLK.f[CLK_C0].scale + (c0 < 0 ? -0.5 : 0.5));
+}
+
+}  // namespace
+
+// CRC-24Q (poly 0x1864CFB), one entry per leading byte
+static const uint32_t CRC_24Q_LookUp[256] = {
+  0x000000,0x864CFB,0x8AD50D,0x0C99F6,0x93E6E1,0x15AA1A,0x1933EC,0x9F7F17,
+  0xA18139,0x27CDC2,0x2B5434,0xAD18CF,0x3267D8,0xB42B23,0xB8B2D5,0x3EFE2E,
+  0xC54E89,0x430272,0x4F9B84,0xC9D77F,0x56A868,0xD0E493,0xDC7D65,0x5A319E,
+  0x64CFB0,0xE2834B,0xEE1ABD,0x685646,0xF72951,0x7165AA,0x7DFC5C,0xFBB0A7,
+  0x0CD1E9,0x8A9D12,0x8604E4,0x00481F,0x9F3708,0x197BF3,0x15E205,0x93AEFE,
+  0xAD50D0,0x2B1C2B,0x2785DD,0xA1C926,0x3EB631,0xB8FACA,0xB4633C,0x322FC7,
+  0xC99F60,0x4FD39B,0x434A6D,0xC50696,0x5A7981,0xDC357A,0xD0AC8C,0x56E077,
+  0x681E59,0xEE52A2,0xE2CB54,0x6487AF,0xFBF8B8,0x7DB443,0x712DB5,0xF7614E,
+  0x19A3D2,0x9FEF29,0x9376DF,0x153A24,0x8A4533,0x0C09C8,0x00903E,0x86DCC5,
+  0xB822EB,0x3E6E10,0x32F7E6,0xB4BB1D,0x2BC40A,0xAD88F1,0xA11107,0x275DFC,
+  0xDCED5B,0x5AA1A0,0x563856,0xD074AD,0x4F0BBA,0xC94741,0xC5DEB7,0x43924C,
+  0x7D6C62,0xFB2099,0xF7B96F,0x71F594,0xEE8A83,0x68C678,0x645F8E,0xE21375,
+  0x15723B,0x933EC0,0x9FA736,0x19EBCD,0x8694DA,0x00D821,0x0C41D7,0x8A0D2C,
+  0xB4F302,0x32BFF9,0x3E260F,0xB86AF4,0x2715E3,0xA15918,0xADC0EE,0x2B8C15,
+  0xD03CB2,0x567049,0x5AE9BF,0xDCA544,0x43DA53,0xC596A8,0xC90F5E,0x4F43A5,
+  0x71BD8B,0xF7F170,0xFB6886,0x7D247D,0xE25B6A,0x641791,0x688E67,0xEEC29C,
+  0x3347A4,0xB50B5F,0xB992A9,0x3FDE52,0xA0A145,0x26EDBE,0x2A7448,0xAC38B3,
+  0x92C69D,0x148A66,0x181390,0x9E5F6B,0x01207C,0x876C87,0x8BF571,0x0DB98A,
+  0xF6092D,0x7045D6,0x7CDC20,0xFA90DB,0x65EFCC,0xE3A337,0xEF3AC1,0x69763A,
+  0x578814,0xD1C4EF,0xDD5D19,0x5B11E2,0xC46EF5,0x42220E,0x4EBBF8,0xC8F703,
+  0x3F964D,0xB9DAB6,0xB54340,0x330FBB,0xAC70AC,0x2A3C57,0x26A5A1,0xA0E95A,
+  0x9E1774,0x185B8F,0x14C279,0x928E82,0x0DF195,0x8BBD6E,0x872498,0x016863,
+  0xFAD8C4,0x7C943F,0x700DC9,0xF64132,0x693E25,0xEF72DE,0xE3EB28,0x65A7D3,
+  0x5B59FD,0xDD1506,0xD18CF0,0x57C00B,0xC8BF1C,0x4EF3E7,0x426A11,0xC426EA,
+  0x2AE476,0xACA88D,0xA0317B,0x267D80,0xB90297,0x3F4E6C,0x33D79A,0xB59B61,
+  0x8B654F,0x0D29B4,0x01B042,0x87FCB9,0x1883AE,0x9ECF55,0x9256A3,0x141A58,
+  0xEFAAFF,0x69E604,0x657FF2,0xE33309,0x7C4C1E,0xFA00E5,0xF69913,0x70D5E8,
+  0x4E2BC6,0xC8673D,0xC4FECB,0x42B230,0xDDCD27,0x5B81DC,0x57182A,0xD154D1,
+  0x26359F,0xA07964,0xACE092,0x2AAC69,0xB5D37E,0x339F85,0x3F0673,0xB94A88,
+  0x87B4A6,0x01F85D,0x0D61AB,0x8B2D50,0x145247,0x921EBC,0x9E874A,0x18CBB1,
+  0xE37B16,0x6537ED,0x69AE1B,0xEFE2E0,0x709DF7,0xF6D10C,0xFA48FA,0x7C0401,
+  0x42FA2F,0xC4B6D4,0xC82F22,0x4E63D9,0xD11CCE,0x575035,0x5BC9C3,0xDD8538
+};
+
+uint32_t b2b_crc24q(const uint8_t* buff, int pos, int len_bits) {
+  uint32_t crc = 0;
+  int i = 0;
+  const int sh = pos & 7;
+  const uint8_t* p = buff + (pos >> 3);
+  for (; i + 8 <= len_bits; i += 8, ++p) {
+    uint8_t b = sh ? uint8_t((p[0] << sh) | (p[1] >> (8 - sh))) : p[0];
+    crc = ((crc << 8) & 0xFFFFFFu) ^ CRC_24Q_LookUp[((crc >> 16) ^ b) & 0xFF];
+  }
+  for (; i < len_bits; ++i) {
+    uint32_t inb = (buff[(pos + i) >> 3] >> (7 - ((pos + i) & 7))) & 1u;
+    crc ^= inb << 23;
+    crc <<= 1;
+    if (crc & 0x1000000u) crc ^= 0x1864CFBu;
+  }
+  return crc & 0xFFFFFFu;
+}
+
+
+int b2b_ldpc_decode(const uint32_t words[B2B_NAV_WORDS], uint8_t out[B2B_MSG_BYTES], b2b_ldpc_info* info) {
+    // The LDPC codeword follows 12 leading bits: 162 GF(64) symbols, MSB first
+    const int SKIP_BITS = 12;
+    SBFcoDecoder::Page page;
+    for (int i = 0; i < 162; ++i) {
+        uint8_t v = 0;
+        for (int b = 0; b < 6; ++b) {
+            int pos = SKIP_BITS + i * 6 + b;
+            v = uint8_t((v << 1) | ((words[pos / 32] >> (31 - pos % 32)) & 1u));
+        }
+        page.syms[i] = v;
+    }
+    SBFcoDecoder::Result res;
+    SBFcoDecoder::decode_page(page, res);
+
+    // The message is the 81 information symbols (486 bits)
+    memset(out, 0, B2B_MSG_BYTES);
+    for (int i = 0; i < B2B_MSG_BITS; ++i) {
+        if ((res.syms[i / 6] >> (5 - i % 6)) & 1) out[i / 8] |= uint8_t(0x80u >> (i % 8));
+    }
+    int crcOk = b2b_crc24q(out, 0, B2B_MSG_BITS - 24) == getbitu(out, B2B_MSG_BITS - 24, 24);
+    if (info) {
+        info->nerr = res.nerr;
+        info->iterations = res.iterations;
+        info->symbols_corrected = 0;
+        for (int i = 0; i < 162; ++i) {
+            if ((res.syms[i] ^ page.syms[i]) & 0x3F) info->symbols_corrected++;
+        }
+        info->crc_ok = crcOk;
+    }
+    if (res.nerr < 0) return -1;
+    return crcOk ? 0 : -2;
+}
+
+int b2b_extract_page(const uint32_t words[B2B_NAV_WORDS], uint8_t out[B2B_MSG_BYTES]) {
+    // Information symbols lead the codeword, right after the 12 skipped bits
+    const int SKIP_BITS = 12;
+    memset(out, 0, B2B_MSG_BYTES);
+    for (int i = 0; i < B2B_MSG_BITS; ++i) {
+        int pos = SKIP_BITS + i;
+        if ((words[pos / 32] >> (31 - pos % 32)) & 1u) out[i / 8] |= uint8_t(0x80u >> (i % 8));
+    }
+    return b2b_crc24q(out, 0, B2B_MSG_BITS - 24) == getbitu(out, B2B_MSG_BITS - 24, 24) ? 0 : -2;
+}
+
+namespace b2b {
+
+Message parse(const uint8_t* buff) {
+    Message msg;
+    int type = raw<HEADER, HDR_TYPE>(buff, 0);
+    int r = HEADER.bits();
+    switch (type) {
+    case 1: {
+        Mt1& m = msg.emplace<Mt1>();
+        parse_header(buff, m);
+        get<MT1, MT1_IODP>(m.iodp, buff, r);
+        read_bitset(buff, r + MT1.bits(), MT1_MASK_BITS, m.prn_mask);
+        break;
+    }
+    case 2: {
+        Mt2& m = msg.emplace<Mt2>();
+        parse_header(buff, m);
+        for (int a = 0; a < MT2_SATS; ++a, r += ORBIT.bits()) parse_orbit(buff, r, &m.sat[a]);
+        break;
+    }
+    case 3: {
+        Mt3& m = msg.emplace<Mt3>();
+        parse_header(buff, m);
+        int num = raw<MT3, MT3_NUM>(buff, r);
+        r += MT3.bits();
+        int a = 0, nbias = 0;
+        for (; a < num && a < 31 && r + MT3_SAT.bits() <= DATA_BITS; ++a) {
+            get<MT3_SAT, DCB_SLOT>(m.sat[a].slot, buff, r);
+            int num4 = raw<MT3_SAT, DCB_NUM>(buff, r);
+            r += MT3_SAT.bits();
+            m.sat[a].first = (unsigned char)nbias;
+            int b = 0;
+            for (; b < num4 && r + MT3_BIAS.bits() <= DATA_BITS; ++b, ++nbias, r += MT3_BIAS.bits()) {
+                get<MT3_BIAS, DCB_PATTERN>(m.bias[nbias].pattern, buff, r);
+                get<MT3_BIAS, DCB_BIAS>(m.bias[nbias].bias, buff, r);
+            }
+            m.sat[a].count = (unsigned char)b;
+        }
+        m.num = (unsigned char)a;
+        m.nbias = (unsigned char)nbias;
+        break;
+    }
+    case 4: {
+        Mt4& m = msg.emplace<Mt4>();
+        parse_header(buff, m);
+        get<MT4, MT4_IODP>(m.iodp, buff, r);
+        get<MT4, MT4_SUBTYPE>(m.subtype, buff, r);
+        r += MT4.bits();
+        for (int a = 0; a < MT4_SATS; ++a, r += MT4_CLK.bits()) {
+            get<MT4_CLK, CLK_IODCORR>(m.iodcorr[a], buff, r);
+            get<MT4_CLK, CLK_C0>(m.c0[a], buff, r);
+        }
+        break;
+    }
+    case 5: {
+        Mt5& m = msg.emplace<Mt5>();
+        parse_header(buff, m);
+        get<MT5, MT5_IODP>(m.iodp, buff, r);
+        get<MT5, MT5_SUBTYPE>(m.subtype, buff, r);
+        r += MT5.bits();
+        for (int a = 0; a < MT5_SATS; ++a, r += MT5_URA.bits()) {
+            get<MT5_URA, URA_CLASS>(m.uraClass[a], buff, r);
+            get<MT5_URA, URA_VALUE>(m.uraValue[a], buff, r);
+        }
+        break;
+    }
+    case 6: {
+        Mt6& m = msg.emplace<Mt6>();
+        parse_header(buff, m);
+        parse_comb(buff, r, false, m);
+        break;
+    }
+    case 7: {
+        Mt7& m = msg.emplace<Mt7>();
+        parse_header(buff, m);
+        parse_comb(buff, r, true, m);
+        break;
+    }
+    default:
+        if (8 <= type && type <= 63) parse_header(buff, msg.emplace<Reserved>());
+        break;
+    }
+    return msg;
+}
+
+}  // namespace b2b
+
+// The C ABI keeps the wide pppdata layout for existing front-ends; it is
+// converted from the typed message and only the used part is written
+int b2b_parse_page(const uint8_t* datapackage, pppdata* PPPB2B) {
+    const uint8_t* buff = datapackage;
+    b2b::Header h;
+    parse_header(buff, h);
+    PPPB2B->mestype = h.type;
+    PPPB2B->BDSsod = h.sod;
+    PPPB2B->nudata = h.nudata;
+    PPPB2B->SSR = h.ssr;
+    PPPB2B->CRC = h.crc;
+
+    const b2b::Message msg = b2b::parse(buff);
+    if (const b2b::Mt1* m = std::get_if<b2b::Mt1>(&msg)) {
+        ppp_sub1& d = PPPB2B->type.type1;
+        d.IODP = m->iodp;
+        memcpy(d.prn_mask, m->prn_mask, sizeof(d.prn_mask));
+        unpack_bits(buff, HEADER.bits() + MT1.bits() + MT1_MASK_BITS, MT1_REV_BITS, d.sub1NULL);
+    } else if (const b2b::Mt2* m = std::get_if<b2b::Mt2>(&msg)) {
+        ppp_sub2& d = PPPB2B->type.type2;
+        for (int a = 0; a < MT2_SATS; ++a) to_trackcp(m->sat[a], &d.trasub[a]);
+        get<MT2_TAIL, 0>(d.sub1NULL, buff, HEADER.bits() + MT2_SATS * ORBIT.bits());
+    } else if (const b2b::Mt3* m = std::get_if<b2b::Mt3>(&msg)) {
+        ppp_sub3& d = PPPB2B->type.type3;
+        d.num = m->num;
+        for (int a = 0; a < m->num; ++a) {
+            Intersymbol_dev& dev = d.intersub3[a];
+            dev.satslot = m->sat[a].slot;
+            dev.num4 = m->sat[a].count;
+            for (int b = 0; b < dev.num4; ++b) {
+                dev.pattern[b] = m->bias[m->sat[a].first + b].pattern;
+                dev.deciation[b] = m->bias[m->sat[a].first + b].bias;
+            }
+        }
+    } else if (const b2b::Mt4* m = std::get_if<b2b::Mt4>(&msg)) {
+        ppp_sub4& d = PPPB2B->type.type4;
+        d.IODP = m->iodp;
+        d.subtupe1 = m->subtype;
+        for (int a = 0; a < MT4_SATS; ++a) {
+            d.IDO_corr[a] = m->iodcorr[a];
+            d.c[a] = m->c0[a];
+        }
+        get<MT4_TAIL, 0>(d.REV, buff, HEADER.bits() + MT4.bits() + MT4_SATS * MT4_CLK.bits());
+    } else if (const b2b::Mt5* m = std::get_if<b2b::Mt5>(&msg)) {
+        ppp_sub5& d = PPPB2B->type.type5;
+        d.IODP = m->iodp;
+        d.subtupe2 = m->subtype;
+        memcpy(d.URAclass, m->uraClass, sizeof(d.URAclass));
+        memcpy(d.URAvalue, m->uraValue, sizeof(d.URAvalue));
+    } else if (const b2b::Mt6* m = std::get_if<b2b::Mt6>(&msg)) {
+        ppp_sub6& d = PPPB2B->type.type6;
+        clock_su6& clk = d.sub6_clock;
+        d.NUMC = m->numc;
+        clk.toc = m->toc;
+        clk.DEV = m->clkDev;
+        clk.IOD_SSR = m->clkIodSsr;
+        clk.IOPD = m->iodp;
+        clk.Slot_S = m->firstSlot;
+        for (int a = 0; a < m->numc; ++a) {
+            clk.clock_N_sub6[a].IOD_corr = m->clk[a].iodcorr;
+            clk.clock_N_sub6[a].Co = raw_c0(m->clk[a].c0);
+        }
+        d.NUMO = m->numo;
+        d.sub6_tarck.tot = m->tot;
+        d.sub6_tarck.DEV = m->orbDev;
+        d.sub6_tarck.IOD_SSR = m->orbIodSsr;
+        for (int a = 0; a < m->numo; ++a) to_trackcp(m->orb[a], &d.sub6_tarck.numO[a]);
+    } else if (const b2b::Mt7* m = std::get_if<b2b::Mt7>(&msg)) {
+        ppp_sub7& d = PPPB2B->type.type7;
+        clock_su7& clk = d.sub7_clock;
+        d.NUMC = m->numc;
+        clk.toc = m->toc;
+        clk.DEV = m->clkDev;
+        clk.IOD_SSR = m->clkIodSsr;
+        for (int a = 0; a < m->numc; ++a) {
+            clk.clock_sub7[a].satslot = m->clk[a].slot;
+            clk.clock_sub7[a].IOD_corr = m->clk[a].iodcorr;
+            clk.clock_sub7[a].Co = raw_c0(m->clk[a].c0);
+        }
+        d.NUMO = m->numo;
+        d.sub7_tarck.tot = m->tot;
+        d.sub7_tarck.DEV = m->orbDev;
+        d.sub7_tarck.IOD_SSR = m->orbIodSsr;
+        for (int a = 0; a < m->numo; ++a) to_trackcp(m->orb[a], &d.sub7_tarck.numO[a]);
+    }
+    return std::holds_alternative<std::monostate>(msg) ? 0 : 1;
+}
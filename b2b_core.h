@@ -0,0 +1,291 @@
+/* Qt-free B2b core: BCNV3 LDPC decoding, CRC-24Q and PPP-B2b message
+ * parsing behind a C ABI, so receiver front-ends outside BNC (e.g. rtklib's
+ * input_unicore/input_sino) can share the kernel PPPB2bDecoder uses.
+ *
+ * Build as a static library together with SBFcoDecoder.cpp, both compiled
+ * with -DSBFCO_NO_QT:
+ *   g++ -O2 -std=c++17 -DSBFCO_NO_QT -c b2b_core.cpp SBFcoDecoder.cpp
+ *   ar rcs libb2bcore.a b2b_core.o SBFcoDecoder.o
+ */
+#ifndef B2B_CORE_H
+#define B2B_CORE_H
+
+#include <stdint.h>
+
+#define IF_MAXSAT 255
+#define B2B_NAV_WORDS 31
+#define B2B_MSG_BITS 486   /* message type + data + CRC-24Q */
+#define B2B_MSG_BYTES 61
+#define B2B_LDPC_BITS 972  /* BCNV3 codeword: 162 GF(64) symbols */
+
+typedef struct {
+    short satslot;
+    unsigned short IODN;
+    unsigned char IODCorr;
+    double radial;
+    double Tangentialdir;
+    double Normaldir;
+    unsigned char URAclass;
+    unsigned char URAvalue;
+    double ura;
+} Trackcp;
+
+typedef struct {
+    unsigned char IODP;
+    uint64_t prn_mask[4];  /* slot k+1 is bit 63-k%64 of prn_mask[k/64], bit 255 clear */
+    char sub1NULL[200];
+} ppp_sub1;
+
+typedef struct {
+    int sub1NULL;
+    Trackcp trasub[6];
+} ppp_sub2;
+
+typedef struct {
+    short satslot;
+    unsigned char num4;
+    unsigned char pattern[16];
+    double deciation[16];
+} Intersymbol_dev;
+
+typedef struct {
+    unsigned char num;
+    Intersymbol_dev intersub3[31];
+} ppp_sub3;
+
+typedef struct {
+    unsigned char IODP;
+    unsigned char subtupe1;
+    unsigned char IDO_corr[23];
+    double c[23];
+    int REV;
+} ppp_sub4;
+
+typedef struct {
+    unsigned char IODP;
+    unsigned char subtupe2;
+    unsigned char URAclass[70];
+    unsigned char URAvalue[70];
+    int REV;
+} ppp_sub5;
+
+typedef struct {
+    unsigned char IOD_corr;
+    int Co;
+} clock_NUMC_sub6;
+
+typedef struct {
+    unsigned int toc;
+    short DEV;
+    unsigned char IOD_SSR;
+    unsigned char IOPD;
+    short Slot_S;
+    clock_NUMC_sub6 clock_N_sub6[22];
+} clock_su6;
+
+typedef struct {
+    unsigned int tot;
+    short DEV;
+    unsigned char IOD_SSR;
+    Trackcp numO[6];
+} track_su6;
+
+typedef struct {
+    unsigned char NUMC;
+    unsigned char NUMO;
+    track_su6 sub6_tarck;
+    clock_su6 sub6_clock;
+} ppp_sub6;
+
+typedef struct {
+    short satslot;
+    unsigned char IOD_corr;
+    int Co;
+} clock_NUMC_sub7;
+
+typedef struct {
+    unsigned int toc;
+    short DEV;
+    unsigned char IOD_SSR;
+    unsigned char IOPD;
+    short Slot_S;
+    clock_NUMC_sub7 clock_sub7[22];
+} clock_su7;
+
+typedef struct {
+    unsigned char NUMC;
+    unsigned char NUMO;
+    track_su6 sub7_tarck;
+    clock_su7 sub7_clock;
+} ppp_sub7;
+
+union ppp_sub_union {
+    ppp_sub1 type1;
+    ppp_sub2 type2;
+    ppp_sub3 type3;
+    ppp_sub4 type4;
+    ppp_sub5 type5;
+    ppp_sub6 type6;
+    ppp_sub7 type7;
+};
+
+typedef struct {
+    short mestype;
+    int CRC;
+    short nudata;
+    unsigned char SSR;
+    short prn;
+    int BDSweek;
+    double BDSsod;
+    double BDSsow;
+    union ppp_sub_union type;
+} pppdata;
+
+typedef struct {
+    int nerr;               /* corrected bits, -1 if parity still fails */
+    int iterations;         /* 0 when the hard-decision fast path settled the page */
+    int symbols_corrected;  /* GF(64) symbols changed by the decoder */
+    int crc_ok;             /* CRC-24Q over bits 0..461 matched */
+} b2b_ldpc_info;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Decode one page given as its 31 NAVBits words (host order, first bit in
+ * the MSB of words[0]) into the 486-bit message, MSB first, in out.
+ * Returns 0 on success, -1 on LDPC parity failure, -2 on CRC-24Q failure;
+ * out and info are filled in every case. info may be NULL. */
+int b2b_ldpc_decode(const uint32_t words[B2B_NAV_WORDS], uint8_t out[B2B_MSG_BYTES], b2b_ldpc_info* info);
+
+/* Take the message straight from the systematic part of the codeword (the
+ * first 486 LDPC bits) without decoding, for pages the receiver already
+ * reports as CRC-passed. Returns 0 if CRC-24Q matches, -2 otherwise; out is
+ * filled in either case. */
+int b2b_extract_page(const uint32_t words[B2B_NAV_WORDS], uint8_t out[B2B_MSG_BYTES]);
+
+/* Parse a decoded message (MSB first, at least B2B_MSG_BITS bits) into msg.
+ * Time fields (BDSweek, BDSsow, prn) are left to the caller. Returns 1 if
+ * the message type is known or reserved (8..63), 0 otherwise. */
+int b2b_parse_page(const uint8_t* bits, pppdata* msg);
+
+/* CRC-24Q over len_bits bits of buff starting at bit pos, MSB first */
+uint32_t b2b_crc24q(const uint8_t* buff, int pos, int len_bits);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+#include <type_traits>
+#include <variant>
+
+/* C++ interface: one compact struct per message type, filled straight from
+ * the message bits. Variable-length groups keep only their used entries'
+ * worth of storage, so the largest alternative is a few hundred bytes. */
+namespace b2b {
+
+#define B2B_MT3_MAX_BIASES 26  /* (pattern, bias) pairs that fit one MT3 */
+
+struct Header {
+    short type;
+    unsigned char ssr;
+    short nudata;
+    double sod;
+    int crc;
+};
+
+struct Orbit {
+    short slot;
+    unsigned short iodn;
+    unsigned char iodcorr;
+    unsigned char uraClass;
+    unsigned char uraValue;
+    float radial;   /* m */
+    float along;    /* m */
+    float cross;    /* m */
+    float ura;      /* mm */
+};
+
+struct Clock {
+    short slot;     /* MT7 only */
+    unsigned char iodcorr;
+    float c0;       /* m */
+};
+
+struct Mt1 : Header {
+    unsigned char iodp;
+    uint64_t prn_mask[4];  /* as ppp_sub1::prn_mask */
+};
+
+struct Mt2 : Header {
+    Orbit sat[6];
+};
+
+struct Mt3 : Header {
+    unsigned char num;
+    unsigned char nbias;
+    struct {
+        short slot;
+        unsigned char first;  /* into bias[] */
+        unsigned char count;
+    } sat[31];
+    struct {
+        unsigned char pattern;
+        float bias;  /* m */
+    } bias[B2B_MT3_MAX_BIASES];
+};
+
+struct Mt4 : Header {
+    unsigned char iodp;
+    unsigned char subtype;
+    unsigned char iodcorr[23];
+    float c0[23];  /* m */
+};
+
+struct Mt5 : Header {
+    unsigned char iodp;
+    unsigned char subtype;
+    unsigned char uraClass[70];
+    unsigned char uraValue[70];
+};
+
+/* MT6 and MT7 share the layout; MT7 clocks carry their own slot and the
+ * clock group has no IODP and first slot */
+struct Combined : Header {
+    unsigned int toc;
+    short clkDev;
+    unsigned char clkIodSsr;
+    unsigned char iodp;
+    short firstSlot;
+    unsigned char numc;
+    Clock clk[22];
+    unsigned int tot;
+    short orbDev;
+    unsigned char orbIodSsr;
+    unsigned char numo;
+    Orbit orb[6];
+};
+struct Mt6 : Combined {};
+struct Mt7 : Combined {};
+
+struct Reserved : Header {};  /* types 8..63 */
+
+/* monostate: unknown message type */
+typedef std::variant<std::monostate, Mt1, Mt2, Mt3, Mt4, Mt5, Mt6, Mt7, Reserved> Message;
+
+/* Parse a decoded message (MSB first, B2B_MSG_BYTES bytes) */
+Message parse(const uint8_t* bits);
+
+/* Common header of a parsed message, NULL for monostate */
+inline const Header* header(const Message& msg) {
+    return std::visit([](const auto& m) -> const Header* {
+        if constexpr (std::is_base_of<Header, std::decay_t<decltype(m)>>::value) return &m;
+        else return nullptr;
+    }, msg);
+}
+
+}  // namespace b2b
+#endif
+
+#endif
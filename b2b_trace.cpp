@@ -0,0 +1,251 @@
+// Per-thread trace rings and the drain thread behind b2b_trace.h
+
+#include "b2b_trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace b2b_trace {
+
+std::atomic<int> g_level(B2B_TRACE_INFO);
+
+namespace {
+
+const uint64_t NO_PENDING = ~uint64_t(0);
+
+// Single-producer ring: only the owning thread moves head, only the drain
+// moves tail. Rings are never freed; a ring left by an exited thread is
+// reused by the next new thread once drained.
+struct Ring {
+    Record                slots[B2B_TRACE_RING_SIZE];
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};
+    // Lower bound of the seq of the record being written, NO_PENDING between
+    // records
+    std::atomic<uint64_t> pending{NO_PENDING};
+    std::atomic<bool>     orphaned{false};
+    Ring*                 next = nullptr;
+};
+
+std::atomic<uint64_t>       g_seq(0);
+std::atomic<uint64_t>       g_dropped(0);
+std::atomic<b2b_trace_sink> g_sink(nullptr);
+std::mutex                  g_ringsMutex;  // ring list changes, once per thread
+Ring*                       g_rings = nullptr;
+std::mutex                  g_drainMutex;  // one drain pass at a time
+uint64_t                    g_droppedReported = 0;
+std::vector<Record>         g_held;        // newer than a record still in flight
+
+class Drain {
+ public:
+    Drain() : _stop(false), _thread(&Drain::run, this) {}
+    ~Drain() {
+        {
+            std::lock_guard<std::mutex> lock(_waitMutex);
+            _stop = true;
+        }
+        _wake.notify_one();
+        _thread.join();
+    }
+ private:
+    void run();
+    std::mutex              _waitMutex;
+    std::condition_variable _wake;
+    bool                    _stop;
+    std::thread             _thread;
+};
+
+struct RingOwner {
+    Ring* ring = nullptr;
+    ~RingOwner() { if (ring) ring->orphaned.store(true, std::memory_order_release); }
+};
+thread_local RingOwner t_owner;
+
+void startDrain() {
+    static Drain drain;
+}
+
+Ring* threadRing() {
+    if (t_owner.ring) return t_owner.ring;
+    std::lock_guard<std::mutex> lock(g_ringsMutex);
+    Ring* ring = nullptr;
+    for (Ring* r = g_rings; r; r = r->next) {
+        if (r->orphaned.load(std::memory_order_acquire) &&
+            r->head.load(std::memory_order_relaxed) == r->tail.load(std::memory_order_acquire)) {
+            r->orphaned.store(false, std::memory_order_relaxed);
+            ring = r;
+            break;
+        }
+    }
+    if (!ring) {
+        ring = new Ring;
+        ring->next = g_rings;
+        g_rings = ring;
+    }
+    t_owner.ring = ring;
+    startDrain();
+    return ring;
+}
+
+// printf one record, one conversion at a time with the argument's stored type
+void format(const Record& rec, std::string& out) {
+    char spec[32];
+    char buf[256];
+    int ai = 0;
+    for (const char* p = rec.fmt; *p;) {
+        if (*p != '%') { out += *p++; continue; }
+        if (p[1] == '%') { out += '%'; p += 2; continue; }
+        const char* q = p + 1;
+        size_t n = 0;
+        spec[n++] = '%';
+        while (*q && strchr("-+ #0123456789.", *q) && n < 24) spec[n++] = *q++;
+        while (*q && strchr("hlLqjzt", *q)) ++q;
+        char conv = *q;
+        if (!conv) break;
+        p = q + 1;
+        if (ai >= rec.nargs) { out += "<?>"; continue; }
+        const Arg& a = rec.args[ai++];
+        long long iv = a.type == Arg::REAL ? (long long)a.d : (a.type == Arg::UINT ? (long long)a.u : a.i);
+        double dv = a.type == Arg::REAL ? a.d : (a.type == Arg::UINT ? double(a.u) : double(a.i));
+        switch (conv) {
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o':
+            if (a.type == Arg::STR) { out += "<?>"; continue; }
+            spec[n++] = 'l'; spec[n++] = 'l'; spec[n++] = conv; spec[n] = '\0';
+            snprintf(buf, sizeof(buf), spec, iv);
+            break;
+        case 'c':
+            spec[n++] = 'c'; spec[n] = '\0';
+            snprintf(buf, sizeof(buf), spec, int(iv));
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+            if (a.type == Arg::STR) { out += "<?>"; continue; }
+            spec[n++] = conv; spec[n] = '\0';
+            snprintf(buf, sizeof(buf), spec, dv);
+            break;
+        case 's':
+            spec[n++] = 's'; spec[n] = '\0';
+            snprintf(buf, sizeof(buf), spec, a.type == Arg::STR ? rec.str + a.str : "<?>");
+            break;
+        default:
+            buf[0] = '\0';
+            break;
+        }
+        out += buf;
+    }
+}
+
+void deliver(int level, const char* text) {
+    b2b_trace_sink sink = g_sink.load(std::memory_order_acquire);
+    if (sink) sink(level, text);
+    else fprintf(stderr, "%s\n", text);
+}
+
+// One pass: delivers, in seq order, every committed record below the
+// oldest one still being written and holds the rest back for the next pass,
+// so the sink sees seq order across threads and passes. Every seq below the
+// returned bound has been delivered.
+uint64_t drainOnce() {
+    std::lock_guard<std::mutex> drainLock(g_drainMutex);
+    std::vector<Record> batch;
+    batch.swap(g_held);
+    // Seqs handed out before this load belong to records that are either
+    // committed or still pending in their ring
+    uint64_t bound = g_seq.load();
+    {
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        for (Ring* r = g_rings; r; r = r->next) bound = std::min(bound, r->pending.load());
+        for (Ring* r = g_rings; r; r = r->next) {
+            uint64_t head = r->head.load(std::memory_order_acquire);
+            uint64_t tail = r->tail.load(std::memory_order_relaxed);
+            for (; tail < head; ++tail) batch.push_back(r->slots[tail & (B2B_TRACE_RING_SIZE - 1)]);
+            r->tail.store(tail, std::memory_order_release);
+        }
+    }
+    std::sort(batch.begin(), batch.end(), [](const Record& a, const Record& b) { return a.seq < b.seq; });
+    std::string text;
+    for (const Record& rec : batch) {
+        if (rec.seq >= bound) {
+            g_held.push_back(rec);
+            continue;
+        }
+        text.clear();
+        format(rec, text);
+        deliver(rec.level, text.c_str());
+    }
+    uint64_t dropped = g_dropped.load(std::memory_order_relaxed);
+    if (dropped != g_droppedReported) {
+        char msg[80];
+        snprintf(msg, sizeof(msg), "b2b trace: %llu records dropped, ring full",
+                 (unsigned long long)(dropped - g_droppedReported));
+        g_droppedReported = dropped;
+        deliver(B2B_TRACE_WARN, msg);
+    }
+    return bound;
+}
+
+}  // namespace
+
+Record* begin(int level, const char* fmt) {
+    Ring* ring = threadRing();
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= B2B_TRACE_RING_SIZE) {
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Record* rec = &ring->slots[head & (B2B_TRACE_RING_SIZE - 1)];
+    // Announced before the seq is taken, so a drain that has seen the seq
+    // counter pass it also sees this record pending
+    ring->pending.store(g_seq.load());
+    rec->seq = g_seq.fetch_add(1);
+    rec->fmt = fmt;
+    rec->level = level;
+    rec->nargs = 0;
+    rec->strUsed = 0;
+    return rec;
+}
+
+void commit(Record*) {
+    Ring* ring = t_owner.ring;
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    ring->pending.store(NO_PENDING, std::memory_order_release);
+}
+
+void Drain::run() {
+    std::unique_lock<std::mutex> lock(_waitMutex);
+    while (!_stop) {
+        _wake.wait_for(lock, std::chrono::milliseconds(20));
+        lock.unlock();
+        drainOnce();
+        lock.lock();
+    }
+}
+
+}  // namespace b2b_trace
+
+void b2b_trace_set_level(int level) {
+    b2b_trace::g_level.store(level, std::memory_order_relaxed);
+}
+
+void b2b_trace_set_sink(b2b_trace_sink sink) {
+    // A drain pass holds g_drainMutex while it calls the sink, so once this
+    // returns the old sink is no longer running and will not be called again
+    std::lock_guard<std::mutex> drainLock(b2b_trace::g_drainMutex);
+    b2b_trace::g_sink.store(sink, std::memory_order_release);
+}
+
+void b2b_trace_flush() {
+    // Waits out records other threads are writing right now; the ones begun
+    // after this call are left to the drain thread
+    uint64_t end = b2b_trace::g_seq.load();
+    while (b2b_trace::drainOnce() < end) std::this_thread::yield();
+}
+
+uint64_t b2b_trace_dropped() {
+    return b2b_trace::g_dropped.load(std::memory_order_relaxed);
+}
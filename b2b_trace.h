@@ -0,0 +1,128 @@
+// Leveled tracing for the B2b pipeline.
+//
+// B2B_TRACE(level, fmt, args...) costs one compare against the runtime level
+// when disabled, and compiles to nothing above B2B_TRACE_COMPILE_LEVEL. An
+// enabled message is stored as a binary record (format pointer plus raw
+// arguments) in a lock-free ring owned by the calling thread; a background
+// thread formats the records and hands the text to the sink in the order
+// the records were begun, across all threads.
+//
+// fmt must be a string literal. Arguments may be integers, enums, floating
+// point or C strings (copied, up to B2B_TRACE_STR_BYTES per record in total);
+// conversions are the printf ones without length modifiers (%d, %u, %x, %c,
+// %f, %e, %g, %s with flags, width and precision).
+#ifndef B2B_TRACE_H
+#define B2B_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+enum B2bTraceLevel {
+    B2B_TRACE_OFF = 0,
+    B2B_TRACE_ERROR,
+    B2B_TRACE_WARN,
+    B2B_TRACE_INFO,     // per message type or epoch
+    B2B_TRACE_DEBUG,    // per page
+    B2B_TRACE_VERBOSE   // per satellite
+};
+
+#ifndef B2B_TRACE_COMPILE_LEVEL
+#define B2B_TRACE_COMPILE_LEVEL B2B_TRACE_VERBOSE
+#endif
+
+#define B2B_TRACE_MAX_ARGS 10
+#define B2B_TRACE_STR_BYTES 200
+#define B2B_TRACE_RING_SIZE 512   /* records per thread, power of two */
+
+// Receives one formatted message, on the drain thread.
+typedef void (*b2b_trace_sink)(int level, const char* text);
+
+void b2b_trace_set_level(int level);
+// Waits for a drain pass in progress, so the previous sink is not called
+// after this returns. Must not be called from a sink.
+void b2b_trace_set_sink(b2b_trace_sink sink);
+// Formats and delivers every record begun before the call, waiting for
+// ones still being written on other threads.
+void b2b_trace_flush();
+// Records lost because a thread's ring was full.
+uint64_t b2b_trace_dropped();
+
+namespace b2b_trace {
+
+extern std::atomic<int> g_level;
+
+struct Arg {
+    enum Type : uint8_t { INT, UINT, REAL, STR } type;
+    union {
+        long long          i;
+        unsigned long long u;
+        double             d;
+        uint16_t           str;  // offset into Record::str
+    };
+};
+
+struct Record {
+    uint64_t    seq;
+    const char* fmt;
+    int         level;
+    int         nargs;
+    int         strUsed;
+    Arg         args[B2B_TRACE_MAX_ARGS];
+    char        str[B2B_TRACE_STR_BYTES];
+};
+
+// Slot in the calling thread's ring, or nullptr when it is full.
+Record* begin(int level, const char* fmt);
+void commit(Record* rec);
+
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+pack(Record* rec, const T& v) {
+    Arg& a = rec->args[rec->nargs++];
+    if (std::is_signed<T>::value || std::is_enum<T>::value) { a.type = Arg::INT; a.i = (long long)v; }
+    else { a.type = Arg::UINT; a.u = (unsigned long long)v; }
+}
+template<typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type
+pack(Record* rec, const T& v) {
+    Arg& a = rec->args[rec->nargs++];
+    a.type = Arg::REAL;
+    a.d = double(v);
+}
+inline void pack(Record* rec, const char* s) {
+    Arg& a = rec->args[rec->nargs++];
+    a.type = Arg::STR;
+    a.str = uint16_t(rec->strUsed);
+    // strUsed stays below B2B_TRACE_STR_BYTES, so there is always room for
+    // the terminator; strings past the pool are truncated
+    char* dst = rec->str + rec->strUsed;
+    int room = B2B_TRACE_STR_BYTES - 1 - rec->strUsed;
+    int n = 0;
+    if (s) while (n < room && s[n]) ++n;
+    if (n > 0) memcpy(dst, s, size_t(n));
+    dst[n] = '\0';
+    rec->strUsed += n + 1;
+    if (rec->strUsed > B2B_TRACE_STR_BYTES - 1) rec->strUsed = B2B_TRACE_STR_BYTES - 1;
+}
+
+template<typename... Args>
+void write(int level, const char* fmt, const Args&... args) {
+    static_assert(sizeof...(Args) <= B2B_TRACE_MAX_ARGS, "too many B2B_TRACE arguments");
+    Record* rec = begin(level, fmt);
+    if (!rec) return;
+    int unused[] = {0, (pack(rec, args), 0)...};
+    (void)unused;
+    commit(rec);
+}
+
+}  // namespace b2b_trace
+
+#define B2B_TRACE_ON(level) \
+    ((level) <= B2B_TRACE_COMPILE_LEVEL && (level) <= b2b_trace::g_level.load(std::memory_order_relaxed))
+
+#define B2B_TRACE(level, ...) \
+    do { if (B2B_TRACE_ON(level)) b2b_trace::write((level), __VA_ARGS__); } while (0)
+
+#endif